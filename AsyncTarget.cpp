@@ -0,0 +1,179 @@
+#include "AsyncTarget.h"
+#include<condition_variable>
+#include<mutex>
+#include<string>
+#include<thread>
+#include<vector>
+
+AsyncTarget::AsyncTarget(OutputTarget &target, int n_threads, size_t max_queued):target(target) {
+
+    max_queued_bytes = max_queued;
+
+    for (int i = 0; i < n_threads; i++) {
+
+        threads.push_back(std::thread(&AsyncTarget::run, this));
+    }
+}
+
+AsyncTarget::~AsyncTarget() {
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        stopping = true;
+    }
+
+    work_ready.notify_all();
+
+    //threads exit once the queue is empty
+    for (int i = 0; i < threads.size(); i++) {
+
+        threads[i].join();
+    }
+}
+
+int AsyncTarget::open(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    open_files[next_id].path = path;
+    pending_paths.insert(path);
+
+    next_id += 1;
+
+    return next_id - 1;
+}
+
+void AsyncTarget::write(int id, const char *data, size_t size) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<char> &file_data = open_files[id].data;
+
+    file_data.insert(file_data.end(), data, data + size);
+}
+
+bool AsyncTarget::close(int id) {
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    QueuedFile &file = open_files[id];
+
+    //wait for writer threads to catch up if too much data is queued
+    batch_done.wait(guard, [&] { return queued_bytes == 0 || queued_bytes + file.data.size() <= max_queued_bytes; });
+
+    queued_bytes += file.data.size();
+
+    queue.push_back(std::move(file));
+    open_files.erase(id);
+
+    guard.unlock();
+
+    work_ready.notify_one();
+
+    //failures are recorded by the wrapped target once the file is written
+    return true;
+}
+
+bool AsyncTarget::exists(const std::string &path) {
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        //file will exist once its queued write completes
+        if (pending_paths.count(path) > 0) return true;
+    }
+
+    return target.exists(path);
+}
+
+void AsyncTarget::create_directory(const std::string &path) {
+
+    //directories are created immediately so that they exist before any queued file inside them is written
+    target.create_directory(path);
+}
+
+bool AsyncTarget::link(const std::string &existing_path, const std::string &path) {
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        batch_done.wait(guard, [&] { return pending_paths.count(existing_path) == 0; });
+    }
+
+    return target.link(existing_path, path);
+}
+
+void AsyncTarget::finish() {
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    batch_done.wait(guard, [&] { return queue.empty() && busy_threads == 0; });
+}
+
+void AsyncTarget::run() {
+
+    //files taken from the queue
+    std::vector<QueuedFile> batch;
+
+    //number of files to take from the queue
+    int batch_size;
+
+    //id of file in target
+    int id;
+
+    while (true) {
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+
+            work_ready.wait(guard, [&] { return stopping || !queue.empty(); });
+
+            if (queue.empty()) return;
+
+            //share queued files between threads, taking at most 64 at once
+            batch_size = queue.size()/threads.size();
+
+            if (batch_size < 1) {
+
+                batch_size = 1;
+
+            } else if (batch_size > 64) {
+
+                batch_size = 64;
+            }
+
+            while (!queue.empty() && batch.size() < batch_size) {
+
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+
+            busy_threads += 1;
+        }
+
+        //write batch
+        for (int i = 0; i < batch.size(); i++) {
+
+            id = target.open(batch[i].path);
+            target.write(id, batch[i].data.data(), batch[i].data.size());
+            target.close(id);
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            for (int i = 0; i < batch.size(); i++) {
+
+                queued_bytes -= batch[i].data.size();
+                pending_paths.erase(pending_paths.find(batch[i].path));
+            }
+
+            busy_threads -= 1;
+        }
+
+        batch.clear();
+
+        batch_done.notify_all();
+    }
+}
@@ -0,0 +1,93 @@
+#include<condition_variable>
+#include<deque>
+#include<map>
+#include<mutex>
+#include<set>
+#include<string>
+#include<thread>
+#include<vector>
+#include "OutputTarget.h"
+
+#ifndef ASYNCTARGET_H
+#define ASYNCTARGET_H
+
+//passes finished files to another target using background writer threads
+//files are queued when closed, so the threads generating output never wait on the file system
+//the wrapped target must allow calls from multiple threads
+class AsyncTarget : public OutputTarget {
+
+public:
+
+    //starts n_threads writer threads
+    //close blocks only if more than max_queued bytes are waiting to be written
+    AsyncTarget(OutputTarget &target, int n_threads = 4, size_t max_queued = 256 << 20);
+
+    //writes all queued files then stops the writer threads
+    ~AsyncTarget();
+
+    int open(const std::string &path);
+    void write(int id, const char *data, size_t size);
+    bool close(int id);
+    bool exists(const std::string &path);
+    void create_directory(const std::string &path);
+
+    //waits for any queued write of existing_path to finish before linking
+    bool link(const std::string &existing_path, const std::string &path);
+
+    //blocks until every queued file has been written
+    void finish();
+
+private:
+
+    //file waiting to be written
+    struct QueuedFile {
+
+        std::string path;
+
+        std::vector<char> data;
+    };
+
+    //target that files are written to
+    OutputTarget &target;
+
+    //files which have been opened but not closed, by id
+    std::map<int, QueuedFile> open_files;
+
+    //closed files waiting for a writer thread
+    std::deque<QueuedFile> queue;
+
+    //paths of files which have been opened but not yet written
+    std::multiset<std::string> pending_paths;
+
+    //number of bytes in queue
+    size_t queued_bytes = 0;
+
+    //number of queued bytes at which close starts to block
+    size_t max_queued_bytes;
+
+    //number of writer threads currently writing a batch
+    int busy_threads = 0;
+
+    //id given to the next opened file
+    int next_id = 0;
+
+    //true when writer threads should exit once the queue is empty
+    bool stopping = false;
+
+    //guards all variables above
+    std::mutex lock;
+
+    //signalled when files are added to the queue
+    std::condition_variable work_ready;
+
+    //signalled when writer threads finish a batch
+    std::condition_variable batch_done;
+
+    //writer threads
+    std::vector<std::thread> threads;
+
+    //writer thread loop, writes batches of queued files
+    void run();
+};
+
+#endif
@@ -0,0 +1,535 @@
+#include "DdsEncoder.h"
+#include<algorithm>
+#include<cmath>
+#include<cstring>
+#include<thread>
+#include<vector>
+
+//converts a colour to 16 bit 565 format, rounding each component
+unsigned short int to_565(const float *colour) {
+
+    int red = std::min(std::max(static_cast<int>(colour[0]*31.0f/255.0f + 0.5f), 0), 31);
+    int green = std::min(std::max(static_cast<int>(colour[1]*63.0f/255.0f + 0.5f), 0), 63);
+    int blue = std::min(std::max(static_cast<int>(colour[2]*31.0f/255.0f + 0.5f), 0), 31);
+
+    return (red << 11) | (green << 5) | blue;
+}
+
+//converts a 16 bit 565 colour back to 8 bit components
+void from_565(unsigned short int value, int *colour) {
+
+    colour[0] = ((value >> 11) & 0x1F)*255/31;
+    colour[1] = ((value >> 5) & 0x3F)*255/63;
+    colour[2] = (value & 0x1F)*255/31;
+}
+
+void DdsEncoder::encode(int width, int height, int format, const std::vector<unsigned char> &rgba, std::vector<char> &dds, int n_threads, bool mipmaps) {
+
+    //number of mipmap levels, including the full size image
+    int n_levels = 1;
+
+    while (mipmaps && std::max(width, height) >> n_levels > 0) {
+
+        n_levels += 1;
+    }
+
+    append_header(dds, width, height, format, n_levels);
+    compress_image(width, height, format, rgba.data(), dds, n_threads);
+
+    if (n_levels == 1) return;
+
+    //fraction of pixels which pass an alpha test in the full size image
+    double coverage = static_cast<double>(alpha_coverage(rgba))/(width*height);
+
+    //current and next mipmap level
+    std::vector<unsigned char> level = rgba;
+    std::vector<unsigned char> next;
+
+    for (int i = 1; i < n_levels; i++) {
+
+        downsample(width, height, level, next);
+
+        width = std::max(width/2, 1);
+        height = std::max(height/2, 1);
+
+        level.swap(next);
+
+        //later levels are filtered from the unscaled alpha values
+        next = level;
+
+        if (format == BC1) {
+
+            scale_coverage(next, static_cast<int>(coverage*width*height + 0.5));
+        }
+
+        compress_image(width, height, format, next.data(), dds, n_threads);
+    }
+}
+
+void DdsEncoder::append_header(std::vector<char> &dds, int width, int height, int format, int n_levels) {
+
+    //size of each block in bytes
+    int block_size = (format == BC1) ? 8 : 16;
+
+    dds.insert(dds.end(), {'D', 'D', 'S', ' '});
+
+    //header size
+    append_little_endian(dds, 124);
+
+    //flags for caps, height, width, pixel format, and linear size, and mipmap count if there are mipmaps
+    append_little_endian(dds, 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000 | ((n_levels > 1) ? 0x20000 : 0));
+
+    append_little_endian(dds, height);
+    append_little_endian(dds, width);
+
+    //size of the compressed image
+    append_little_endian(dds, ((width + 3)/4)*((height + 3)/4)*block_size);
+
+    //depth
+    append_little_endian(dds, 0);
+
+    append_little_endian(dds, (n_levels > 1) ? n_levels : 0);
+
+    //11 reserved values
+    for (int i = 0; i < 11; i++) {
+
+        append_little_endian(dds, 0);
+    }
+
+    //pixel format size and flags, with the format given by a four character code
+    append_little_endian(dds, 32);
+    append_little_endian(dds, (format == BC1) ? 0x4 | 0x1 : 0x4);
+
+    dds.insert(dds.end(), {'D', 'X', 'T', (format == BC1) ? '1' : '5'});
+
+    //bit count and masks, unused for compressed formats
+    for (int i = 0; i < 5; i++) {
+
+        append_little_endian(dds, 0);
+    }
+
+    //caps for a texture, and for a texture with mipmaps, followed by 3 unused caps and a reserved value
+    append_little_endian(dds, 0x1000 | ((n_levels > 1) ? 0x8 | 0x400000 : 0));
+
+    for (int i = 0; i < 4; i++) {
+
+        append_little_endian(dds, 0);
+    }
+}
+
+void DdsEncoder::downsample(int width, int height, const std::vector<unsigned char> &rgba, std::vector<unsigned char> &half) {
+
+    int half_width = std::max(width/2, 1);
+    int half_height = std::max(height/2, 1);
+
+    half.resize(4*half_width*half_height);
+
+    for (int i = 0; i < half_height; i++) {
+
+        for (int j = 0; j < half_width; j++) {
+
+            //sums of alpha weighted colours, unweighted colours, and alpha in the square
+            int weighted[3] = {0, 0, 0};
+            int unweighted[3] = {0, 0, 0};
+            int alpha = 0;
+
+            //images with an odd size, or with a size of 1, reuse the last row or column
+            for (int k = 0; k < 4; k++) {
+
+                int x = std::min(2*j + k%2, width - 1);
+                int y = std::min(2*i + k/2, height - 1);
+
+                const unsigned char *pixel = rgba.data() + 4*(y*width + x);
+
+                for (int c = 0; c < 3; c++) {
+
+                    weighted[c] += pixel[c]*pixel[3];
+                    unweighted[c] += pixel[c];
+                }
+
+                alpha += pixel[3];
+            }
+
+            unsigned char *pixel = half.data() + 4*(i*half_width + j);
+
+            for (int c = 0; c < 3; c++) {
+
+                pixel[c] = (alpha > 0) ? (weighted[c] + alpha/2)/alpha : (unweighted[c] + 2)/4;
+            }
+
+            pixel[3] = (alpha + 2)/4;
+        }
+    }
+}
+
+int DdsEncoder::alpha_coverage(const std::vector<unsigned char> &rgba) {
+
+    int coverage = 0;
+
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+
+        if (rgba[i] >= 128) {
+
+            coverage += 1;
+        }
+    }
+
+    return coverage;
+}
+
+void DdsEncoder::scale_coverage(std::vector<unsigned char> &rgba, int coverage) {
+
+    //number of pixels with each alpha value
+    int histogram[256] = {};
+
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+
+        histogram[rgba[i]] += 1;
+    }
+
+    //lowest alpha which must pass the alpha test, found by counting down from the most opaque pixels
+    //pixels with the same alpha all pass or all fail, so the threshold giving the nearest number of pixels is used
+    int threshold = 256;
+    int count = 0;
+
+    while (threshold > 1 && count < coverage) {
+
+        int next_count = count + histogram[threshold - 1];
+
+        //the most opaque pixels always pass if any should, so that textures do not disappear
+        if (count > 0 && next_count - coverage > coverage - count) break;
+
+        threshold -= 1;
+        count = next_count;
+    }
+
+    //highest alpha in the image, used when no pixels should pass
+    int max_alpha = 255;
+
+    while (max_alpha > 0 && histogram[max_alpha] == 0) {
+
+        max_alpha -= 1;
+    }
+
+    for (size_t i = 3; i < rgba.size(); i += 4) {
+
+        //scale so that threshold becomes 128, or so that the most opaque pixel is just below 128
+        int alpha = (threshold == 256) ? rgba[i]*127/(max_alpha + 1) : rgba[i]*128/threshold;
+
+        rgba[i] = std::min(alpha, 255);
+    }
+}
+
+void DdsEncoder::append_little_endian(std::vector<char> &data, unsigned int value) {
+
+    data.push_back(value & 0xFF);
+    data.push_back((value >> 8) & 0xFF);
+    data.push_back((value >> 16) & 0xFF);
+    data.push_back((value >> 24) & 0xFF);
+}
+
+void DdsEncoder::compress_image(int width, int height, int format, const unsigned char *rgba, std::vector<char> &out, int n_threads) {
+
+    //size of each block in bytes
+    int block_size = (format == BC1) ? 8 : 16;
+
+    //number of blocks in each direction
+    int blocks_x = (width + 3)/4;
+    int blocks_y = (height + 3)/4;
+
+    size_t start = out.size();
+
+    out.resize(start + blocks_x*blocks_y*block_size);
+
+    unsigned char *blocks = reinterpret_cast<unsigned char *>(out.data() + start);
+
+    //compresses every n_workers-th row of blocks starting from first
+    auto compress_rows = [&](int first, int n_workers) {
+
+        //pixels of current block
+        unsigned char block[64];
+
+        for (int i = first; i < blocks_y; i += n_workers) {
+
+            for (int j = 0; j < blocks_x; j++) {
+
+                //blocks past the edge of the image repeat the last row or column
+                for (int k = 0; k < 16; k++) {
+
+                    int x = std::min(4*j + k%4, width - 1);
+                    int y = std::min(4*i + k/4, height - 1);
+
+                    std::memcpy(block + 4*k, rgba + 4*(y*width + x), 4);
+                }
+
+                unsigned char *block_out = blocks + (i*blocks_x + j)*block_size;
+
+                if (format == BC1) {
+
+                    compress_colour_block(block, true, block_out);
+
+                } else {
+
+                    compress_alpha_block(block, block_out);
+                    compress_colour_block(block, false, block_out + 8);
+                }
+            }
+        }
+    };
+
+    int n_workers = std::min(n_threads, blocks_y);
+
+    if (n_workers > 1) {
+
+        std::vector<std::thread> workers;
+
+        for (int i = 0; i < n_workers; i++) {
+
+            workers.push_back(std::thread(compress_rows, i, n_workers));
+        }
+
+        for (int i = 0; i < workers.size(); i++) {
+
+            workers[i].join();
+        }
+
+    } else {
+
+        compress_rows(0, 1);
+    }
+}
+
+void DdsEncoder::compress_colour_block(const unsigned char *block, bool transparency, unsigned char *out) {
+
+    //true for each pixel stored as transparent
+    bool transparent[16];
+
+    bool any_transparent = false;
+
+    //mean colour of opaque pixels
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+
+    int n_opaque = 0;
+
+    for (int i = 0; i < 16; i++) {
+
+        transparent[i] = transparency && block[4*i + 3] < 128;
+
+        if (transparent[i]) {
+
+            any_transparent = true;
+            continue;
+        }
+
+        for (int j = 0; j < 3; j++) {
+
+            mean[j] += block[4*i + j];
+        }
+
+        n_opaque += 1;
+    }
+
+    //fully transparent blocks use 3 colour mode with every pixel set to transparent
+    if (n_opaque == 0) {
+
+        std::memset(out, 0, 4);
+        std::memset(out + 4, 0xFF, 4);
+
+        return;
+    }
+
+    for (int j = 0; j < 3; j++) {
+
+        mean[j] /= n_opaque;
+    }
+
+    //covariance of opaque pixel colours
+    float covariance[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (int i = 0; i < 16; i++) {
+
+        if (transparent[i]) continue;
+
+        float r = block[4*i] - mean[0];
+        float g = block[4*i + 1] - mean[1];
+        float b = block[4*i + 2] - mean[2];
+
+        covariance[0] += r*r;
+        covariance[1] += r*g;
+        covariance[2] += r*b;
+        covariance[3] += g*g;
+        covariance[4] += g*b;
+        covariance[5] += b*b;
+    }
+
+    //principal axis of the colours, found by power iteration
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+
+    for (int i = 0; i < 8; i++) {
+
+        float next[3];
+
+        next[0] = covariance[0]*axis[0] + covariance[1]*axis[1] + covariance[2]*axis[2];
+        next[1] = covariance[1]*axis[0] + covariance[3]*axis[1] + covariance[4]*axis[2];
+        next[2] = covariance[2]*axis[0] + covariance[4]*axis[1] + covariance[5]*axis[2];
+
+        float length = std::max(std::max(std::fabs(next[0]), std::fabs(next[1])), std::fabs(next[2]));
+
+        //all colours are the same
+        if (length == 0.0f) break;
+
+        for (int j = 0; j < 3; j++) {
+
+            axis[j] = next[j]/length;
+        }
+    }
+
+    //endpoints are the extent of the colours along the axis
+    float min_projection = 0.0f;
+    float max_projection = 0.0f;
+
+    for (int i = 0; i < 16; i++) {
+
+        if (transparent[i]) continue;
+
+        float projection = (block[4*i] - mean[0])*axis[0] + (block[4*i + 1] - mean[1])*axis[1] + (block[4*i + 2] - mean[2])*axis[2];
+
+        min_projection = std::min(min_projection, projection);
+        max_projection = std::max(max_projection, projection);
+    }
+
+    float axis_length = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+
+    float start[3];
+    float end[3];
+
+    for (int j = 0; j < 3; j++) {
+
+        start[j] = mean[j] + axis[j]*max_projection/axis_length;
+        end[j] = mean[j] + axis[j]*min_projection/axis_length;
+    }
+
+    unsigned short int colour_0 = to_565(start);
+    unsigned short int colour_1 = to_565(end);
+
+    //blocks with transparent pixels must use 3 colour mode, where colour_0 <= colour_1, and other blocks use 4 colour mode, where colour_0 > colour_1
+    if (any_transparent ? colour_0 > colour_1 : colour_0 < colour_1) {
+
+        std::swap(colour_0, colour_1);
+    }
+
+    //colours which can be stored in the block
+    int palette[4][3];
+
+    from_565(colour_0, palette[0]);
+    from_565(colour_1, palette[1]);
+
+    //number of colours which can be chosen for opaque pixels
+    int n_colours = 4;
+
+    for (int j = 0; j < 3; j++) {
+
+        if (colour_0 > colour_1) {
+
+            palette[2][j] = (2*palette[0][j] + palette[1][j])/3;
+            palette[3][j] = (palette[0][j] + 2*palette[1][j])/3;
+
+        } else {
+
+            palette[2][j] = (palette[0][j] + palette[1][j])/2;
+            palette[3][j] = 0;
+
+            n_colours = 3;
+        }
+    }
+
+    //2 bit index of each pixel
+    unsigned int indices = 0;
+
+    for (int i = 0; i < 16; i++) {
+
+        int index = 3;
+
+        if (!transparent[i]) {
+
+            int best_distance = 0x7FFFFFFF;
+
+            for (int k = 0; k < n_colours; k++) {
+
+                int r = block[4*i] - palette[k][0];
+                int g = block[4*i + 1] - palette[k][1];
+                int b = block[4*i + 2] - palette[k][2];
+
+                int distance = r*r + g*g + b*b;
+
+                if (distance < best_distance) {
+
+                    best_distance = distance;
+                    index = k;
+                }
+            }
+        }
+
+        indices |= index << 2*i;
+    }
+
+    out[0] = colour_0 & 0xFF;
+    out[1] = colour_0 >> 8;
+    out[2] = colour_1 & 0xFF;
+    out[3] = colour_1 >> 8;
+
+    for (int i = 0; i < 4; i++) {
+
+        out[4 + i] = (indices >> 8*i) & 0xFF;
+    }
+}
+
+void DdsEncoder::compress_alpha_block(const unsigned char *block, unsigned char *out) {
+
+    int alpha_0 = 0;
+    int alpha_1 = 255;
+
+    for (int i = 0; i < 16; i++) {
+
+        alpha_0 = std::max(alpha_0, static_cast<int>(block[4*i + 3]));
+        alpha_1 = std::min(alpha_1, static_cast<int>(block[4*i + 3]));
+    }
+
+    out[0] = alpha_0;
+    out[1] = alpha_1;
+
+    //8 alpha values are interpolated between alpha_0 and alpha_1 when alpha_0 > alpha_1
+    int palette[8] = {alpha_0, alpha_1};
+
+    for (int k = 1; k < 7; k++) {
+
+        palette[k + 1] = ((7 - k)*alpha_0 + k*alpha_1)/7;
+    }
+
+    //3 bit index of each pixel
+    unsigned long long indices = 0;
+
+    for (int i = 0; i < 16; i++) {
+
+        int index = 0;
+        int best_distance = 256;
+
+        for (int k = 0; k < 8 && alpha_0 > alpha_1; k++) {
+
+            int distance = std::abs(block[4*i + 3] - palette[k]);
+
+            if (distance < best_distance) {
+
+                best_distance = distance;
+                index = k;
+            }
+        }
+
+        indices |= static_cast<unsigned long long>(index) << 3*i;
+    }
+
+    for (int i = 0; i < 6; i++) {
+
+        out[2 + i] = (indices >> 8*i) & 0xFF;
+    }
+}
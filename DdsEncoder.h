@@ -0,0 +1,55 @@
+#include<vector>
+
+#ifndef DDSENCODER_H
+#define DDSENCODER_H
+
+//writes images as block compressed .dds files, which can be uploaded to a gpu without decoding
+//each 4x4 block of pixels is compressed independently, so blocks are shared between threads
+//files can include a full chain of mipmaps, each half the size of the previous level, down to 1x1
+class DdsEncoder {
+
+public:
+
+    //block compression formats
+    //BC1 stores colour and 1 bit alpha in 8 bytes per block, BC3 stores colour and 8 bit alpha in 16 bytes per block
+    static const int BC1 = 1;
+    static const int BC3 = 3;
+
+    //encodes an image and appends the .dds file to dds
+    //rgba holds the red, green, blue, and alpha values of each pixel, from the top row to the bottom row
+    //with BC1, pixels with alpha below 128 are stored as transparent black
+    //if mipmaps is true, mipmaps are generated with a box filter
+    //for BC1, the alpha of each mipmap is scaled so that the same fraction of pixels have alpha of at least 128 as in the full size image, so that alpha tested textures do not fade out with distance
+    //blocks are compressed by n_threads threads
+    static void encode(int width, int height, int format, const std::vector<unsigned char> &rgba, std::vector<char> &dds, int n_threads = 1, bool mipmaps = false);
+
+private:
+
+    //appends the dds header for an image with n_levels mipmap levels to dds
+    static void append_header(std::vector<char> &dds, int width, int height, int format, int n_levels);
+
+    //halves the size of an image, averaging each 2x2 square of pixels into half
+    //colours are weighted by alpha, so that transparent pixels do not darken the edges of opaque areas
+    static void downsample(int width, int height, const std::vector<unsigned char> &rgba, std::vector<unsigned char> &half);
+
+    //returns the number of pixels in an image with alpha of at least 128
+    static int alpha_coverage(const std::vector<unsigned char> &rgba);
+
+    //scales the alpha of an image so that coverage pixels have alpha of at least 128, as near as possible
+    static void scale_coverage(std::vector<unsigned char> &rgba, int coverage);
+
+    //appends a 4 byte little endian value to data
+    static void append_little_endian(std::vector<char> &data, unsigned int value);
+
+    //compresses every block of an image, appending the blocks to out
+    static void compress_image(int width, int height, int format, const unsigned char *rgba, std::vector<char> &out, int n_threads);
+
+    //compresses the colours of a block of 16 pixels, each 4 bytes, to 8 bytes at out
+    //if transparency is true, pixels with alpha below 128 are stored as transparent, which is only possible in BC1 blocks
+    static void compress_colour_block(const unsigned char *block, bool transparency, unsigned char *out);
+
+    //compresses the alpha values of a block of 16 pixels, each 4 bytes, to 8 bytes at out
+    static void compress_alpha_block(const unsigned char *block, unsigned char *out);
+};
+
+#endif
@@ -0,0 +1,639 @@
+#include "Deflate.h"
+#include<algorithm>
+#include<cstddef>
+#include<cstring>
+#include<mutex>
+#include<queue>
+#include<vector>
+
+//first match length and number of extra bits for each length symbol
+const int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+//first distance and number of extra bits for each distance symbol
+const int DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+//order in which code length code lengths are stored
+const int CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+//lz77 settings
+const int WINDOW_SIZE = 32768;
+const int MIN_MATCH = 3;
+const int MAX_MATCH = 258;
+const int HASH_BITS = 15;
+
+//number of earlier positions checked for each match
+const int MAX_CHAIN = 48;
+
+//matches at least this long are taken without checking the next position for a longer one
+const int NICE_MATCH = 128;
+
+//writes bits to a byte vector, least significant bit first
+struct deflate_bits {
+
+    std::vector<char> &out;
+
+    unsigned long long buffer = 0;
+
+    int count = 0;
+
+    deflate_bits(std::vector<char> &out):out(out) {}
+
+    void put(unsigned int value, int n_bits) {
+
+        buffer |= static_cast<unsigned long long>(value) << count;
+        count += n_bits;
+
+        while (count >= 8) {
+
+            out.push_back(buffer & 0xFF);
+
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    //pads to a byte boundary with zero bits
+    void align() {
+
+        if (count > 0) {
+
+            put(0, 8 - count);
+        }
+    }
+};
+
+//lz77 output, a literal if distance is 0, otherwise a match
+struct deflate_token {
+
+    unsigned short int value;
+
+    unsigned short int distance;
+};
+
+//define static variables
+
+//crc lookup table
+unsigned int Deflate::crc_table[256];
+
+//length symbol minus 257 for each match length
+unsigned char Deflate::length_symbols[259];
+
+//distance symbol for each distance up to 256, and for each 128 byte range of larger distances
+unsigned char Deflate::distance_symbols[512];
+
+//ensures tables are initialised once
+std::once_flag Deflate::tables_init;
+
+void Deflate::compress(const char *data, size_t size, size_t dict_size, bool final, std::vector<char> &out) {
+
+    std::call_once(tables_init, init_tables);
+
+    if (dict_size > WINDOW_SIZE) {
+
+        dict_size = WINDOW_SIZE;
+    }
+
+    //dictionary followed by data
+    const unsigned char *window = reinterpret_cast<const unsigned char *>(data) - dict_size;
+    size_t window_size = dict_size + size;
+
+    //most recent position with each hash, and the previous position with the same hash as each position
+    std::vector<int> head(1 << HASH_BITS, -1);
+    std::vector<int> prev(window_size);
+
+    //adds position to hash chains
+    auto insert = [&](size_t position) {
+
+        if (position + MIN_MATCH > window_size) return;
+
+        unsigned int hash = ((window[position] << 10) ^ (window[position + 1] << 5) ^ window[position + 2]) & ((1 << HASH_BITS) - 1);
+
+        prev[position] = head[hash];
+        head[hash] = position;
+    };
+
+    //finds longest earlier match for position, returning its length and setting distance
+    auto find_match = [&](size_t position, int &distance) {
+
+        int best_length = 0;
+
+        //longest possible match
+        int max_length = std::min<size_t>(MAX_MATCH, window_size - position);
+
+        if (max_length < MIN_MATCH) return 0;
+
+        unsigned int hash = ((window[position] << 10) ^ (window[position + 1] << 5) ^ window[position + 2]) & ((1 << HASH_BITS) - 1);
+
+        int candidate = head[hash];
+
+        for (int i = 0; i < MAX_CHAIN && candidate >= 0 && position - candidate <= WINDOW_SIZE; i++) {
+
+            //only compare candidates which could beat the current best
+            if (window[candidate + best_length] == window[position + best_length]) {
+
+                int length = 0;
+
+                while (length < max_length && window[candidate + length] == window[position + length]) {
+
+                    length += 1;
+                }
+
+                if (length > best_length) {
+
+                    best_length = length;
+                    distance = position - candidate;
+
+                    if (length == max_length) break;
+                }
+            }
+
+            candidate = prev[candidate];
+        }
+
+        return (best_length >= MIN_MATCH) ? best_length : 0;
+    };
+
+    //add dictionary to hash chains
+    for (size_t i = 0; i < dict_size; i++) {
+
+        insert(i);
+    }
+
+    //find matches, checking whether the next position has a longer match before taking one
+    std::vector<deflate_token> tokens;
+
+    tokens.reserve(size/2 + 1);
+
+    size_t position = dict_size;
+
+    int length = 0;
+    int distance = 0;
+
+    //true if length and distance hold the match at position
+    bool have_match = false;
+
+    while (position < window_size) {
+
+        if (!have_match) {
+
+            length = find_match(position, distance);
+        }
+
+        insert(position);
+
+        have_match = false;
+
+        if (length == 0) {
+
+            tokens.push_back({window[position], 0});
+
+            position += 1;
+
+            continue;
+        }
+
+        //check for a longer match at the next position
+        if (length < NICE_MATCH && position + 1 < window_size) {
+
+            int next_distance = 0;
+            int next_length = find_match(position + 1, next_distance);
+
+            if (next_length > length) {
+
+                tokens.push_back({window[position], 0});
+
+                position += 1;
+
+                length = next_length;
+                distance = next_distance;
+                have_match = true;
+
+                continue;
+            }
+        }
+
+        tokens.push_back({static_cast<unsigned short int>(length), static_cast<unsigned short int>(distance)});
+
+        for (int i = 1; i < length; i++) {
+
+            insert(position + i);
+        }
+
+        position += length;
+    }
+
+    //count symbol frequencies
+    unsigned int literal_frequencies[286] = {};
+    unsigned int distance_frequencies[30] = {};
+
+    for (int i = 0; i < tokens.size(); i++) {
+
+        if (tokens[i].distance == 0) {
+
+            literal_frequencies[tokens[i].value] += 1;
+
+        } else {
+
+            literal_frequencies[257 + length_symbols[tokens[i].value]] += 1;
+            distance_frequencies[distance_symbol(tokens[i].distance)] += 1;
+        }
+    }
+
+    //end of block
+    literal_frequencies[256] = 1;
+
+    //build huffman codes
+    unsigned char literal_lengths[286];
+    unsigned char distance_lengths[30];
+    unsigned short int literal_codes[286];
+    unsigned short int distance_codes[30];
+
+    build_lengths(literal_frequencies, 286, 15, literal_lengths);
+    build_lengths(distance_frequencies, 30, 15, distance_lengths);
+    build_codes(literal_lengths, 286, literal_codes);
+    build_codes(distance_lengths, 30, distance_codes);
+
+    //number of codes stored
+    int n_literals = 286;
+    int n_distances = 30;
+
+    while (n_literals > 257 && literal_lengths[n_literals - 1] == 0) {
+
+        n_literals -= 1;
+    }
+
+    while (n_distances > 1 && distance_lengths[n_distances - 1] == 0) {
+
+        n_distances -= 1;
+    }
+
+    //run length encode code lengths, storing each code length symbol followed by its extra bits value
+    std::vector<unsigned char> all_lengths(literal_lengths, literal_lengths + n_literals);
+
+    all_lengths.insert(all_lengths.end(), distance_lengths, distance_lengths + n_distances);
+
+    std::vector<unsigned char> length_symbols_used;
+    unsigned int code_length_frequencies[19] = {};
+
+    for (int i = 0; i < all_lengths.size();) {
+
+        //length of run of equal code lengths
+        int run = 1;
+
+        while (i + run < all_lengths.size() && all_lengths[i + run] == all_lengths[i]) {
+
+            run += 1;
+        }
+
+        if (all_lengths[i] == 0 && run >= 11) {
+
+            run = std::min(run, 138);
+
+            length_symbols_used.push_back(18);
+            length_symbols_used.push_back(run - 11);
+
+        } else if (all_lengths[i] == 0 && run >= 3) {
+
+            length_symbols_used.push_back(17);
+            length_symbols_used.push_back(run - 3);
+
+        } else if (all_lengths[i] != 0 && run >= 4) {
+
+            //the first length is stored directly, then repeated
+            run = std::min(run, 7);
+
+            length_symbols_used.push_back(all_lengths[i]);
+            length_symbols_used.push_back(0);
+            length_symbols_used.push_back(16);
+            length_symbols_used.push_back(run - 4);
+
+            code_length_frequencies[all_lengths[i]] += 1;
+
+        } else {
+
+            run = 1;
+
+            length_symbols_used.push_back(all_lengths[i]);
+            length_symbols_used.push_back(0);
+        }
+
+        code_length_frequencies[length_symbols_used[length_symbols_used.size() - 2]] += 1;
+
+        i += run;
+    }
+
+    unsigned char code_length_lengths[19];
+    unsigned short int code_length_codes[19];
+
+    build_lengths(code_length_frequencies, 19, 7, code_length_lengths);
+    build_codes(code_length_lengths, 19, code_length_codes);
+
+    int n_code_lengths = 19;
+
+    while (n_code_lengths > 4 && code_length_lengths[CODE_LENGTH_ORDER[n_code_lengths - 1]] == 0) {
+
+        n_code_lengths -= 1;
+    }
+
+    //size of block with dynamic codes in bits
+    unsigned long long dynamic_bits = 17 + 3*n_code_lengths;
+
+    for (int i = 0; i < 19; i++) {
+
+        dynamic_bits += code_length_frequencies[i]*code_length_lengths[i];
+    }
+
+    dynamic_bits += code_length_frequencies[16]*2 + code_length_frequencies[17]*3 + code_length_frequencies[18]*7;
+
+    for (int i = 0; i < 286; i++) {
+
+        dynamic_bits += literal_frequencies[i]*(literal_lengths[i] + ((i >= 257) ? LENGTH_EXTRA[i - 257] : 0));
+    }
+
+    for (int i = 0; i < 30; i++) {
+
+        dynamic_bits += distance_frequencies[i]*(distance_lengths[i] + DISTANCE_EXTRA[i]);
+    }
+
+    deflate_bits bits(out);
+
+    //store data directly if compression would make it larger
+    if (dynamic_bits/8 + 1 >= size + 5*(size/65535 + 1)) {
+
+        size_t stored = 0;
+
+        do {
+
+            size_t block_size = std::min<size_t>(size - stored, 65535);
+
+            bits.put((final && stored + block_size == size) ? 1 : 0, 1);
+            bits.put(0, 2);
+            bits.align();
+            bits.put(block_size, 16);
+            bits.put(block_size ^ 0xFFFF, 16);
+
+            out.insert(out.end(), data + stored, data + stored + block_size);
+
+            stored += block_size;
+
+        } while (stored < size);
+
+    } else {
+
+        //block header
+        bits.put(final ? 1 : 0, 1);
+        bits.put(2, 2);
+        bits.put(n_literals - 257, 5);
+        bits.put(n_distances - 1, 5);
+        bits.put(n_code_lengths - 4, 4);
+
+        for (int i = 0; i < n_code_lengths; i++) {
+
+            bits.put(code_length_lengths[CODE_LENGTH_ORDER[i]], 3);
+        }
+
+        for (int i = 0; i < length_symbols_used.size(); i += 2) {
+
+            int symbol = length_symbols_used[i];
+
+            bits.put(code_length_codes[symbol], code_length_lengths[symbol]);
+
+            if (symbol == 16) {
+
+                bits.put(length_symbols_used[i + 1], 2);
+
+            } else if (symbol == 17) {
+
+                bits.put(length_symbols_used[i + 1], 3);
+
+            } else if (symbol == 18) {
+
+                bits.put(length_symbols_used[i + 1], 7);
+            }
+        }
+
+        //block data
+        for (int i = 0; i < tokens.size(); i++) {
+
+            if (tokens[i].distance == 0) {
+
+                bits.put(literal_codes[tokens[i].value], literal_lengths[tokens[i].value]);
+
+            } else {
+
+                int symbol = length_symbols[tokens[i].value];
+
+                bits.put(literal_codes[257 + symbol], literal_lengths[257 + symbol]);
+                bits.put(tokens[i].value - LENGTH_BASE[symbol], LENGTH_EXTRA[symbol]);
+
+                symbol = distance_symbol(tokens[i].distance);
+
+                bits.put(distance_codes[symbol], distance_lengths[symbol]);
+                bits.put(tokens[i].distance - DISTANCE_BASE[symbol], DISTANCE_EXTRA[symbol]);
+            }
+        }
+
+        bits.put(literal_codes[256], literal_lengths[256]);
+    }
+
+    //empty stored block, which ends the output on a byte boundary
+    if (!final) {
+
+        bits.put(0, 3);
+        bits.align();
+        bits.put(0, 16);
+        bits.put(0xFFFF, 16);
+    }
+
+    bits.align();
+}
+
+unsigned int Deflate::crc32(unsigned int crc, const char *data, size_t size) {
+
+    std::call_once(tables_init, init_tables);
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < size; i++) {
+
+        crc = crc_table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+void Deflate::init_tables() {
+
+    for (unsigned int i = 0; i < 256; i++) {
+
+        unsigned int c = i;
+
+        for (int j = 0; j < 8; j++) {
+
+            c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+        }
+
+        crc_table[i] = c;
+    }
+
+    for (int i = 0; i < 29; i++) {
+
+        for (int j = LENGTH_BASE[i]; j < LENGTH_BASE[i] + (1 << LENGTH_EXTRA[i]) && j <= MAX_MATCH; j++) {
+
+            length_symbols[j] = i;
+        }
+    }
+
+    //length 258 has its own symbol, rather than being the last length of symbol 27
+    length_symbols[258] = 28;
+
+    for (int i = 0; i < 30; i++) {
+
+        for (int j = DISTANCE_BASE[i]; j < DISTANCE_BASE[i] + (1 << DISTANCE_EXTRA[i]); j++) {
+
+            if (j <= 256) {
+
+                distance_symbols[j - 1] = i;
+
+            } else {
+
+                distance_symbols[256 + ((j - 1) >> 7)] = i;
+            }
+        }
+    }
+}
+
+int Deflate::distance_symbol(int distance) {
+
+    return (distance <= 256) ? distance_symbols[distance - 1] : distance_symbols[256 + ((distance - 1) >> 7)];
+}
+
+void Deflate::build_lengths(const unsigned int *frequencies, int n_symbols, int limit, unsigned char *lengths) {
+
+    std::vector<unsigned int> counts(frequencies, frequencies + n_symbols);
+
+    //a code needs at least two symbols
+    int n_used = 0;
+
+    for (int i = 0; i < n_symbols; i++) {
+
+        if (counts[i] > 0) {
+
+            n_used += 1;
+        }
+    }
+
+    for (int i = 0; i < n_symbols && n_used < 2; i++) {
+
+        if (counts[i] == 0) {
+
+            counts[i] = 1;
+            n_used += 1;
+        }
+    }
+
+    while (true) {
+
+        //huffman tree, with leaves for each used symbol followed by internal nodes
+        std::vector<int> parents;
+        std::vector<int> leaf_symbols;
+
+        //queue of node weights and indices, with the lowest weight first
+        std::priority_queue<std::pair<unsigned long long, int>, std::vector<std::pair<unsigned long long, int>>, std::greater<std::pair<unsigned long long, int>>> queue;
+
+        for (int i = 0; i < n_symbols; i++) {
+
+            if (counts[i] > 0) {
+
+                queue.push(std::make_pair(counts[i], parents.size()));
+                parents.push_back(-1);
+                leaf_symbols.push_back(i);
+            }
+        }
+
+        while (queue.size() > 1) {
+
+            std::pair<unsigned long long, int> a = queue.top();
+            queue.pop();
+            std::pair<unsigned long long, int> b = queue.top();
+            queue.pop();
+
+            parents[a.second] = parents.size();
+            parents[b.second] = parents.size();
+
+            queue.push(std::make_pair(a.first + b.first, parents.size()));
+            parents.push_back(-1);
+        }
+
+        //depth of each leaf gives its code length
+        std::memset(lengths, 0, n_symbols);
+
+        int max_length = 0;
+
+        for (int i = 0; i < leaf_symbols.size(); i++) {
+
+            int depth = 0;
+
+            for (int node = i; parents[node] != -1; node = parents[node]) {
+
+                depth += 1;
+            }
+
+            lengths[leaf_symbols[i]] = depth;
+            max_length = std::max(max_length, depth);
+        }
+
+        if (max_length <= limit) return;
+
+        //flatten frequencies until the tree is shallow enough
+        for (int i = 0; i < n_symbols; i++) {
+
+            if (counts[i] > 0) {
+
+                counts[i] = (counts[i] >> 1) | 1;
+            }
+        }
+    }
+}
+
+void Deflate::build_codes(const unsigned char *lengths, int n_symbols, unsigned short int *codes) {
+
+    //number of codes of each length
+    int length_counts[16] = {};
+
+    for (int i = 0; i < n_symbols; i++) {
+
+        length_counts[lengths[i]] += 1;
+    }
+
+    length_counts[0] = 0;
+
+    //first code of each length
+    int next_code[16] = {};
+
+    int code = 0;
+
+    for (int i = 1; i < 16; i++) {
+
+        code = (code + length_counts[i - 1]) << 1;
+        next_code[i] = code;
+    }
+
+    //huffman codes are stored most significant bit first, so bits are reversed for output
+    for (int i = 0; i < n_symbols; i++) {
+
+        codes[i] = 0;
+
+        if (lengths[i] == 0) continue;
+
+        code = next_code[lengths[i]];
+        next_code[lengths[i]] += 1;
+
+        for (int j = 0; j < lengths[i]; j++) {
+
+            codes[i] |= ((code >> j) & 1) << (lengths[i] - 1 - j);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include<cstddef>
+#include<mutex>
+#include<vector>
+
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+//deflate compressor, producing data which can be read by zlib and gzip
+//input is compressed with lz77 matching and a dynamic huffman code for each call
+class Deflate {
+
+public:
+
+    //compresses size bytes at data, appending raw deflate blocks to out
+    //matches may refer to the dict_size bytes before data, at most 32768 of which are used
+    //if final is false, the output ends with an empty stored block so that further output can be appended on a byte boundary
+    static void compress(const char *data, size_t size, size_t dict_size, bool final, std::vector<char> &out);
+
+    //updates a crc32 checksum, starting from 0, with size bytes at data
+    static unsigned int crc32(unsigned int crc, const char *data, size_t size);
+
+private:
+
+    //crc lookup table
+    static unsigned int crc_table[256];
+
+    //length symbol minus 257 for each match length
+    static unsigned char length_symbols[259];
+
+    //distance symbol for each distance up to 256, and for each 128 byte range of larger distances
+    static unsigned char distance_symbols[512];
+
+    //ensures tables are initialised once, as compression may run on several threads
+    static std::once_flag tables_init;
+
+    //generates lookup tables
+    static void init_tables();
+
+    //returns distance symbol for distance
+    static int distance_symbol(int distance);
+
+    //sets the huffman code length of each symbol from its frequency, with no code longer than limit
+    static void build_lengths(const unsigned int *frequencies, int n_symbols, int limit, unsigned char *lengths);
+
+    //sets the canonical huffman code of each symbol from its code length, with bits reversed for output
+    static void build_codes(const unsigned char *lengths, int n_symbols, unsigned short int *codes);
+};
+
+#endif
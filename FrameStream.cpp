@@ -0,0 +1,321 @@
+#include "FrameStream.h"
+#include "OutFile.h"
+#include<cmath>
+#include<cstring>
+#include<fstream>
+#include<string>
+#include<vector>
+
+//appends the bytes of value to data
+template <typename T>
+void stream_append(std::vector<char> &data, T value) {
+
+    const char *bytes = reinterpret_cast<const char *>(&value);
+
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+//reads a value from data at offset
+template <typename T>
+T stream_read(const std::vector<char> &data, size_t offset) {
+
+    T value;
+
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+
+    return value;
+}
+
+void FrameStream::write(std::string path, const std::vector<std::vector<float>> &frames, const std::vector<int> &clip_starts, const std::vector<int> &clip_lengths, int keyframe_interval) {
+
+    //number of vertices in each frame
+    int n_vertices = (frames.size() > 0) ? frames[0].size()/3 : 0;
+
+    //number of keyframes
+    int n_keyframes = (frames.size() + keyframe_interval - 1)/keyframe_interval;
+
+    //find bounding box of all frames
+    float minimum[3] = {0, 0, 0};
+    float maximum[3] = {0, 0, 0};
+
+    for (int i = 0; i < frames.size(); i++) {
+
+        for (int j = 0; j < n_vertices; j++) {
+
+            for (int k = 0; k < 3; k++) {
+
+                if ((i == 0 && j == 0) || frames[i][3*j + k] < minimum[k]) {
+
+                    minimum[k] = frames[i][3*j + k];
+                }
+
+                if ((i == 0 && j == 0) || frames[i][3*j + k] > maximum[k]) {
+
+                    maximum[k] = frames[i][3*j + k];
+                }
+            }
+        }
+    }
+
+    //quantisation step along each axis
+    float step[3];
+
+    for (int i = 0; i < 3; i++) {
+
+        step[i] = (maximum[i] - minimum[i])/65535.0f;
+    }
+
+    //write header
+    std::vector<char> header;
+
+    const char identifier[4] = {'D', 'F', 'S', '1'};
+
+    header.insert(header.end(), identifier, identifier + 4);
+    stream_append<unsigned int>(header, n_vertices);
+    stream_append<unsigned int>(header, frames.size());
+    stream_append<unsigned int>(header, keyframe_interval);
+
+    for (int i = 0; i < 3; i++) {
+
+        stream_append<float>(header, minimum[i]);
+    }
+
+    for (int i = 0; i < 3; i++) {
+
+        stream_append<float>(header, step[i]);
+    }
+
+    stream_append<unsigned int>(header, clip_starts.size());
+
+    for (int i = 0; i < clip_starts.size(); i++) {
+
+        stream_append<unsigned int>(header, clip_starts[i]);
+        stream_append<unsigned int>(header, clip_lengths[i]);
+    }
+
+    //encode frames, storing the offset of each keyframe
+    std::vector<char> frame_data;
+    std::vector<unsigned int> keyframe_offsets;
+
+    //offset of frame data from start of file
+    size_t data_offset = header.size() + 4*n_keyframes;
+
+    //quantised values of previous and current frames, stored as all x, then all y, then all z
+    std::vector<int> prev_values(3*n_vertices);
+    std::vector<int> values(3*n_vertices);
+
+    for (int i = 0; i < frames.size(); i++) {
+
+        for (int j = 0; j < 3; j++) {
+
+            for (int k = 0; k < n_vertices; k++) {
+
+                values[j*n_vertices + k] = (step[j] > 0) ? std::lround((frames[i][3*k + j] - minimum[j])/step[j]) : 0;
+
+                if (values[j*n_vertices + k] > 65535) {
+
+                    values[j*n_vertices + k] = 65535;
+                }
+            }
+        }
+
+        //keyframes store values directly
+        if (i%keyframe_interval == 0) {
+
+            keyframe_offsets.push_back(data_offset + frame_data.size());
+
+            for (int j = 0; j < values.size(); j++) {
+
+                stream_append<unsigned short int>(frame_data, values[j]);
+            }
+
+        //other frames store zigzag encoded differences as varints
+        } else {
+
+            for (int j = 0; j < values.size(); j++) {
+
+                int delta = values[j] - prev_values[j];
+                unsigned int zigzag = (static_cast<unsigned int>(delta) << 1) ^ static_cast<unsigned int>(delta >> 31);
+
+                while (zigzag >= 0x80) {
+
+                    frame_data.push_back((zigzag & 0x7F) | 0x80);
+                    zigzag >>= 7;
+                }
+
+                frame_data.push_back(zigzag);
+            }
+        }
+
+        prev_values.swap(values);
+    }
+
+    //write stream file
+    OutFile DFS_file(path);
+
+    DFS_file.write(header.data(), header.size());
+    DFS_file.write(reinterpret_cast<const char *>(keyframe_offsets.data()), 4*keyframe_offsets.size());
+    DFS_file.write(frame_data.data(), frame_data.size());
+
+    DFS_file.close();
+}
+
+bool FrameStreamReader::open(std::string path) {
+
+    std::ifstream DFS_file(path, std::ios::binary);
+
+    if (!DFS_file) return false;
+
+    data.assign(std::istreambuf_iterator<char>(DFS_file), std::istreambuf_iterator<char>());
+
+    //check header
+    if (data.size() < 0x2C || std::memcmp(data.data(), "DFS1", 4) != 0) return false;
+
+    n_vertices = stream_read<unsigned int>(data, 0x04);
+    n_frames = stream_read<unsigned int>(data, 0x08);
+    keyframe_interval = stream_read<unsigned int>(data, 0x0C);
+
+    for (int i = 0; i < 3; i++) {
+
+        minimum[i] = stream_read<float>(data, 0x10 + 4*i);
+        step[i] = stream_read<float>(data, 0x1C + 4*i);
+    }
+
+    if (keyframe_interval < 1) return false;
+
+    int n_clips = stream_read<unsigned int>(data, 0x28);
+    int n_keyframes = (n_frames + keyframe_interval - 1)/keyframe_interval;
+
+    //read clip and keyframe tables
+    size_t offset = 0x2C;
+
+    if (data.size() < offset + 8*n_clips + 4*n_keyframes) return false;
+
+    clip_starts.clear();
+    clip_lengths.clear();
+
+    for (int i = 0; i < n_clips; i++) {
+
+        clip_starts.push_back(stream_read<unsigned int>(data, offset));
+        clip_lengths.push_back(stream_read<unsigned int>(data, offset + 4));
+
+        offset += 8;
+    }
+
+    keyframe_offsets.clear();
+
+    for (int i = 0; i < n_keyframes; i++) {
+
+        keyframe_offsets.push_back(stream_read<unsigned int>(data, offset));
+
+        offset += 4;
+    }
+
+    current_frame = -1;
+    current_values.assign(3*n_vertices, 0);
+
+    return true;
+}
+
+int FrameStreamReader::vertex_count() {
+
+    return n_vertices;
+}
+
+int FrameStreamReader::frame_count() {
+
+    return n_frames;
+}
+
+int FrameStreamReader::clip_count() {
+
+    return clip_starts.size();
+}
+
+int FrameStreamReader::clip_start(int clip) {
+
+    return clip_starts[clip];
+}
+
+int FrameStreamReader::clip_length(int clip) {
+
+    return clip_lengths[clip];
+}
+
+bool FrameStreamReader::read_frame(int frame, std::vector<float> &positions) {
+
+    if (frame < 0 || frame >= n_frames) return false;
+
+    //seek to keyframe unless the frame follows the current frame in the same keyframe interval
+    if (current_frame == -1 || frame < current_frame || frame/keyframe_interval != current_frame/keyframe_interval) {
+
+        current_frame = (frame/keyframe_interval)*keyframe_interval - 1;
+        next_offset = keyframe_offsets[frame/keyframe_interval];
+    }
+
+    //decode forward to frame
+    while (current_frame < frame) {
+
+        if (!decode_next()) {
+
+            current_frame = -1;
+
+            return false;
+        }
+    }
+
+    //convert quantised values to positions
+    positions.resize(3*n_vertices);
+
+    for (int i = 0; i < 3; i++) {
+
+        for (int j = 0; j < n_vertices; j++) {
+
+            positions[3*j + i] = minimum[i] + step[i]*current_values[i*n_vertices + j];
+        }
+    }
+
+    return true;
+}
+
+bool FrameStreamReader::decode_next() {
+
+    current_frame += 1;
+
+    //keyframe values are stored directly
+    if (current_frame%keyframe_interval == 0) {
+
+        if (next_offset + 2*current_values.size() > data.size()) return false;
+
+        for (int i = 0; i < current_values.size(); i++) {
+
+            current_values[i] = stream_read<unsigned short int>(data, next_offset);
+
+            next_offset += 2;
+        }
+
+        return true;
+    }
+
+    //other frames are added to the previous frame
+    for (int i = 0; i < current_values.size(); i++) {
+
+        unsigned int zigzag = 0;
+        int shift = 0;
+
+        do {
+
+            if (next_offset >= data.size() || shift > 28) return false;
+
+            zigzag |= (data[next_offset] & 0x7F) << shift;
+            shift += 7;
+
+            next_offset += 1;
+
+        } while (data[next_offset - 1] & 0x80);
+
+        current_values[i] += static_cast<int>(zigzag >> 1) ^ -static_cast<int>(zigzag & 1);
+    }
+
+    return true;
+}
@@ -0,0 +1,97 @@
+#include<string>
+#include<vector>
+
+#ifndef FRAMESTREAM_H
+#define FRAMESTREAM_H
+
+//compact binary stream of animated vertex positions
+//
+//all values are little endian
+//0x00  char[4]   identifier "DFS1"
+//0x04  uint32    number of vertices
+//0x08  uint32    number of frames
+//0x0C  uint32    keyframe interval, every frame whose index is a multiple of this is a keyframe
+//0x10  float[3]  minimum corner of bounding box of all frames
+//0x1C  float[3]  quantisation step along each axis, position = minimum + step*quantised value
+//0x28  uint32    number of clips
+//0x2C  uint32[2] first frame and number of frames for each clip
+//then  uint32    offset from start of file to each keyframe
+//then  frame data
+//
+//positions are quantised to 16 bits within the bounding box
+//keyframes store the quantised values of each vertex as uint16
+//other frames store the difference from the previous frame as zigzag encoded varints, so small movements take a single byte
+//each frame stores all x values, then all y values, then all z values, so that similar values are grouped together
+class FrameStream {
+
+public:
+
+    //writes frames to a stream file at path
+    //each frame holds xyz triplets for every vertex, clip_starts and clip_lengths are indices into frames
+    static void write(std::string path, const std::vector<std::vector<float>> &frames, const std::vector<int> &clip_starts, const std::vector<int> &clip_lengths, int keyframe_interval = 30);
+};
+
+//reads streams written by FrameStream
+//any frame can be read by decoding forward from the keyframe before it
+class FrameStreamReader {
+
+public:
+
+    //loads stream from path
+    //returns false if the file cannot be read or is not a frame stream
+    bool open(std::string path);
+
+    //returns number of vertices in each frame
+    int vertex_count();
+
+    //returns number of frames in stream
+    int frame_count();
+
+    //returns number of animation clips
+    int clip_count();
+
+    //returns index of the first frame in clip
+    int clip_start(int clip);
+
+    //returns number of frames in clip
+    int clip_length(int clip);
+
+    //decodes frame into positions as xyz triplets
+    //reading frames in order only decodes one frame at a time
+    //returns false if frame is out of range
+    bool read_frame(int frame, std::vector<float> &positions);
+
+private:
+
+    //contents of stream file
+    std::vector<char> data;
+
+    //header values
+    int n_vertices = 0;
+    int n_frames = 0;
+    int keyframe_interval = 1;
+    float minimum[3];
+    float step[3];
+
+    //first frame and number of frames for each clip
+    std::vector<int> clip_starts;
+    std::vector<int> clip_lengths;
+
+    //offset to each keyframe
+    std::vector<unsigned int> keyframe_offsets;
+
+    //index of most recently decoded frame, -1 if no frame has been decoded
+    int current_frame = -1;
+
+    //quantised values of most recently decoded frame, stored as all x, then all y, then all z
+    std::vector<int> current_values;
+
+    //offset to data of the frame after current_frame
+    size_t next_offset = 0;
+
+    //decodes the frame at next_offset into current_values
+    //returns false if the data ends early
+    bool decode_next();
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "Glb.h"
+#include<string>
+#include<vector>
+#include "TextBuffer.h"
+
+int Glb::add_view(std::vector<glb_view> &views, std::vector<char> &bin, int start, int target) {
+
+    glb_view view;
+
+    view.offset = start;
+    view.length = bin.size() - start;
+    view.target = target;
+
+    views.push_back(view);
+
+    while (bin.size()%4 != 0) {
+
+        bin.push_back(0);
+    }
+
+    return views.size() - 1;
+}
+
+int Glb::add_accessor(std::vector<glb_accessor> &accessors, std::vector<glb_view> &views, std::vector<char> &bin, int start, int component_type, std::string type, int count, int target, bool bounds) {
+
+    glb_accessor accessor;
+
+    accessor.component_type = component_type;
+    accessor.type = type;
+    accessor.count = count;
+
+    if (bounds && count > 0) {
+
+        //number of components in each element
+        int n_components = bin.size() - start;
+
+        n_components /= 4*count;
+
+        const float *data = reinterpret_cast<const float *>(bin.data() + start);
+
+        accessor.min.assign(data, data + n_components);
+        accessor.max.assign(data, data + n_components);
+
+        for (int i = 0; i < count; i++) {
+
+            for (int j = 0; j < n_components; j++) {
+
+                if (data[i*n_components + j] < accessor.min[j]) {
+
+                    accessor.min[j] = data[i*n_components + j];
+                }
+
+                if (data[i*n_components + j] > accessor.max[j]) {
+
+                    accessor.max[j] = data[i*n_components + j];
+                }
+            }
+        }
+    }
+
+    accessor.view = add_view(views, bin, start, target);
+
+    accessors.push_back(accessor);
+
+    return accessors.size() - 1;
+}
+
+void Glb::write_floats(TextBuffer &out, const double *values, int count) {
+
+    for (int i = 0; i < count; i++) {
+
+        if (i != 0) {
+
+            out << ',';
+        }
+
+        out.write_exact(values[i]);
+    }
+}
@@ -0,0 +1,84 @@
+#include<string>
+#include<vector>
+#include "TextBuffer.h"
+
+#ifndef GLB_H
+#define GLB_H
+
+//glb buffer view, a region of the binary chunk
+struct glb_view {
+
+    //offset of data in binary chunk
+    int offset;
+
+    //length of data in bytes
+    int length;
+
+    //buffer view target, 0 if the view has no target
+    int target;
+};
+
+//glb accessor describing the elements stored in a buffer view
+struct glb_accessor {
+
+    //buffer view containing the data
+    int view;
+
+    //gltf component type, e.g. 5126 for float
+    int component_type;
+
+    //gltf element type, e.g. "VEC3"
+    std::string type;
+
+    //number of elements
+    int count;
+
+    //bounds of each component, empty if bounds are not written
+    std::vector<float> min;
+    std::vector<float> max;
+};
+
+//glb animation channel, each channel has its own sampler
+struct glb_channel {
+
+    //accessor of keyframe times
+    int input;
+
+    //accessor of keyframe values
+    int output;
+
+    //node animated by the channel
+    int node;
+
+    //animated property, "translation", "rotation" or "scale"
+    std::string path;
+};
+
+//builds the binary chunk and json descriptions of buffer views and accessors for .glb files
+class Glb {
+
+public:
+
+    //appends the bytes of value to a glb binary chunk
+    template <typename T>
+    static void append(std::vector<char> &bin, T value) {
+
+        const char *bytes = reinterpret_cast<const char *>(&value);
+
+        bin.insert(bin.end(), bytes, bytes + sizeof(T));
+    }
+
+    //adds a buffer view for the data appended to bin since start, then pads bin to a multiple of 4 bytes
+    //returns index of the buffer view
+    static int add_view(std::vector<glb_view> &views, std::vector<char> &bin, int start, int target);
+
+    //adds an accessor and buffer view for the count elements appended to bin since start
+    //component bounds are calculated when bounds is true, which requires float components
+    //returns index of the accessor
+    static int add_accessor(std::vector<glb_accessor> &accessors, std::vector<glb_view> &views, std::vector<char> &bin, int start, int component_type, std::string type, int count, int target, bool bounds);
+
+    //writes a comma separated list of float values to out
+    static void write_floats(TextBuffer &out, const double *values, int count);
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "GzipTarget.h"
+#include "Deflate.h"
+#include<algorithm>
+#include<map>
+#include<mutex>
+#include<string>
+#include<thread>
+#include<vector>
+
+//appends a 4 byte little endian value to data
+void append_little_endian(std::vector<char> &data, unsigned int value) {
+
+    for (int i = 0; i < 4; i++) {
+
+        data.push_back((value >> 8*i) & 0xFF);
+    }
+}
+
+//define static variables
+
+//size of the blocks that files are compressed in
+const size_t GzipTarget::BLOCK_SIZE;
+
+//amount of earlier data that matches in a block may refer to
+const size_t GzipTarget::DICTIONARY_SIZE;
+
+GzipTarget::GzipTarget(OutputTarget &target, int n_threads):target(target) {
+
+    this->n_threads = std::max(n_threads, 1);
+}
+
+int GzipTarget::open(const std::string &path) {
+
+    GzipFile file;
+
+    file.compressed = is_compressed(path);
+    file.target_id = target.open(file.compressed ? path + ".gz" : path);
+
+    if (file.compressed) {
+
+        //gzip header with deflate compression, no flags or modification time, and unknown operating system
+        const char header[10] = {0x1F, static_cast<char>(0x8B), 8, 0, 0, 0, 0, 0, 0, static_cast<char>(0xFF)};
+
+        target.write(file.target_id, header, 10);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    open_files[next_id] = std::move(file);
+    next_id += 1;
+
+    return next_id - 1;
+}
+
+void GzipTarget::write(int id, const char *data, size_t size) {
+
+    GzipFile &file = get_file(id);
+
+    if (!file.compressed) {
+
+        target.write(file.target_id, data, size);
+
+        return;
+    }
+
+    file.pending.insert(file.pending.end(), data, data + size);
+
+    //compress all complete blocks
+    size_t n_blocks = (file.pending.size() - file.dict_size)/BLOCK_SIZE;
+
+    if (n_blocks > 0) {
+
+        compress(file, n_blocks*BLOCK_SIZE, false);
+    }
+}
+
+bool GzipTarget::close(int id) {
+
+    GzipFile &file = get_file(id);
+
+    if (file.compressed) {
+
+        compress(file, file.pending.size() - file.dict_size, true);
+
+        //gzip trailer
+        std::vector<char> trailer;
+
+        append_little_endian(trailer, file.crc);
+        append_little_endian(trailer, file.size & 0xFFFFFFFF);
+
+        target.write(file.target_id, trailer.data(), trailer.size());
+    }
+
+    bool written = target.close(file.target_id);
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    open_files.erase(id);
+
+    return written;
+}
+
+bool GzipTarget::exists(const std::string &path) {
+
+    return target.exists(is_compressed(path) ? path + ".gz" : path);
+}
+
+void GzipTarget::create_directory(const std::string &path) {
+
+    target.create_directory(path);
+}
+
+bool GzipTarget::link(const std::string &existing_path, const std::string &path) {
+
+    if (is_compressed(path)) {
+
+        return target.link(existing_path + ".gz", path + ".gz");
+    }
+
+    return target.link(existing_path, path);
+}
+
+bool GzipTarget::is_compressed(const std::string &path) {
+
+    const std::string extensions[3] = {".dae", ".obj", ".mtl"};
+
+    for (int i = 0; i < 3; i++) {
+
+        if (path.size() >= 4 && path.compare(path.size() - 4, 4, extensions[i]) == 0) return true;
+    }
+
+    return false;
+}
+
+GzipTarget::GzipFile &GzipTarget::get_file(int id) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    return open_files[id];
+}
+
+void GzipTarget::compress(GzipFile &file, size_t length, bool final) {
+
+    //start of data to compress
+    const char *data = file.pending.data() + file.dict_size;
+
+    //number of blocks, at least one so that a final block is always written
+    size_t n_blocks = std::max<size_t>((length + BLOCK_SIZE - 1)/BLOCK_SIZE, 1);
+
+    //compressed data of each block
+    std::vector<std::vector<char>> blocks(n_blocks);
+
+    //compresses every n_workers-th block starting from first
+    auto compress_blocks = [&](size_t first, size_t n_workers) {
+
+        for (size_t i = first; i < n_blocks; i += n_workers) {
+
+            size_t start = i*BLOCK_SIZE;
+            size_t block_length = std::min(BLOCK_SIZE, length - std::min(start, length));
+
+            //each block may refer back into the previous block, or to already compressed data for the first block
+            size_t dict_size = std::min(DICTIONARY_SIZE, file.dict_size + start);
+
+            Deflate::compress(data + start, block_length, dict_size, final && i == n_blocks - 1, blocks[i]);
+        }
+    };
+
+    size_t n_workers = std::min<size_t>(n_threads, n_blocks);
+
+    if (n_workers > 1) {
+
+        std::vector<std::thread> workers;
+
+        for (size_t i = 0; i < n_workers; i++) {
+
+            workers.push_back(std::thread(compress_blocks, i, n_workers));
+        }
+
+        for (size_t i = 0; i < workers.size(); i++) {
+
+            workers[i].join();
+        }
+
+    } else {
+
+        compress_blocks(0, 1);
+    }
+
+    for (size_t i = 0; i < n_blocks; i++) {
+
+        target.write(file.target_id, blocks[i].data(), blocks[i].size());
+    }
+
+    file.crc = Deflate::crc32(file.crc, data, length);
+    file.size += length;
+
+    //keep the end of the compressed data for matches in the next block
+    size_t compressed_end = file.dict_size + length;
+    size_t keep = std::min(DICTIONARY_SIZE, compressed_end);
+
+    file.pending.erase(file.pending.begin(), file.pending.begin() + (compressed_end - keep));
+    file.dict_size = keep;
+}
@@ -0,0 +1,82 @@
+#include<map>
+#include<mutex>
+#include<string>
+#include<vector>
+#include "OutputTarget.h"
+
+#ifndef GZIPTARGET_H
+#define GZIPTARGET_H
+
+//compresses text files with gzip before passing them to another target
+//.dae, .obj, and .mtl files are written to path + ".gz", and all other files are passed on unchanged
+//data is compressed as it is written, in blocks which can be compressed by several threads at once
+//files may be written from multiple threads if the wrapped target allows it
+class GzipTarget : public OutputTarget {
+
+public:
+
+    //n_threads threads are used to compress the blocks of each file
+    GzipTarget(OutputTarget &target, int n_threads = 1);
+
+    int open(const std::string &path);
+    void write(int id, const char *data, size_t size);
+    bool close(int id);
+    bool exists(const std::string &path);
+    void create_directory(const std::string &path);
+    bool link(const std::string &existing_path, const std::string &path);
+
+    //returns true if files at path are compressed
+    static bool is_compressed(const std::string &path);
+
+private:
+
+    //size of the blocks that files are compressed in
+    static const size_t BLOCK_SIZE = 1 << 17;
+
+    //amount of earlier data that matches in a block may refer to
+    static const size_t DICTIONARY_SIZE = 32768;
+
+    //file being written
+    struct GzipFile {
+
+        //id of file in target
+        int target_id;
+
+        //true if the file is compressed
+        bool compressed;
+
+        //end of the data which has already been compressed, followed by data waiting to be compressed
+        std::vector<char> pending;
+
+        //number of bytes at the start of pending which have already been compressed
+        size_t dict_size = 0;
+
+        //crc32 and size of uncompressed data
+        unsigned int crc = 0;
+        unsigned long long size = 0;
+    };
+
+    //target that files are written to
+    OutputTarget &target;
+
+    //number of threads used to compress blocks
+    int n_threads;
+
+    //open files by id
+    std::map<int, GzipFile> open_files;
+
+    //id given to the next opened file
+    int next_id = 0;
+
+    //guards open_files and next_id
+    std::mutex lock;
+
+    //returns the open file with id
+    GzipFile &get_file(int id);
+
+    //compresses the first length bytes of pending data in file and writes them to the target
+    //if final is true, the compressed data ends the deflate stream
+    void compress(GzipFile &file, size_t length, bool final);
+};
+
+#endif
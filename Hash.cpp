@@ -0,0 +1,48 @@
+#include "Hash.h"
+#include<cstddef>
+#include<cstring>
+#include<string>
+
+unsigned long long Hash::hash64(const char *data, size_t size) {
+
+    //mixes 8 bytes at a time, finishing with any remaining bytes
+    unsigned long long h = 0x9E3779B97F4A7C15ULL ^ size;
+    unsigned long long word;
+
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+
+        std::memcpy(&word, data + i, 8);
+
+        h = (h ^ word)*0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+
+    for (; i < size; i++) {
+
+        h = (h ^ static_cast<unsigned char>(data[i]))*0x100000001B3ULL;
+    }
+
+    //final mixing so that every input bit affects every output bit
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+std::string Hash::hex(unsigned long long value) {
+
+    const char digits[] = "0123456789abcdef";
+
+    std::string hex_digits(16, '0');
+
+    for (int i = 15; i >= 0; i--) {
+
+        hex_digits[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+
+    return hex_digits;
+}
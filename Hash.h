@@ -0,0 +1,19 @@
+#include<cstddef>
+#include<string>
+
+#ifndef HASH_H
+#define HASH_H
+
+//fast non-cryptographic hash used to detect changed or identical data
+class Hash {
+
+public:
+
+    //returns a 64 bit hash of size bytes at data
+    static unsigned long long hash64(const char *data, size_t size);
+
+    //returns value as 16 hex digits
+    static std::string hex(unsigned long long value);
+};
+
+#endif
@@ -366,77 +366,72 @@ std::vector<double> Joint::transform_vector(std::vector<double> vertex) {
     return out_vec;
 }
 
-std::string Joint::pose_collada() {
+void Joint::pose_collada(TextBuffer &out) {
 
-    std::string out;
-
-    //write matrix to out string
+    //write matrix to out
     for (int i = 0; i < 4; i++) {
 
         for (int j = 0; j < 4; j++) {
 
-            out = out + std::to_string(inverse_transform[j][i]);
+            out.write_fixed(inverse_transform[j][i]);
 
             if (j != 3) {
 
-                out = out + " ";
+                out << ' ';
             }
         }
 
         if (i != 3) {
 
-            out = out + " ";
+            out << ' ';
         }
     }
 
     //recursively write child joint matrices
     for (int i = 0; i < children.size(); i++) {
 
-        out = out + " " + children[i]->pose_collada();
+        out << ' ';
+        children[i]->pose_collada(out);
     }
-
-    return out;
 }
 
-std::string Joint::collada(int depth, double accum_scale) {
+void Joint::collada(TextBuffer &out, int depth, double accum_scale) {
 
     std::string spacing(2*depth, ' ');
 
     //create joint node
-    std::string out = spacing + "<node id=\"joint_" + std::to_string(order) + "\" sid=\"joint_" + std::to_string(order) + "\" name=\"joint." + std::to_string(order) + "\" type=\"JOINT\">\n"
-                    + spacing + "  <matrix sid=\"transform\">";
-    
-    bool zero_offset = (joint_space[3][0] == 0 && joint_space[3][1] == 0 && joint_space[3][2] == 0);
+    out << spacing << "<node id=\"joint_" << order << "\" sid=\"joint_" << order << "\" name=\"joint." << order << "\" type=\"JOINT\">\n"
+        << spacing << "  <matrix sid=\"transform\">";
 
-    //write joint space matrix to out string
+    //write joint space matrix to out
     for (int i = 0; i < 4; i++) {
 
         for (int j = 0; j < 4; j++) {
-                
-            out = out + std::to_string(joint_space[j][i]);
+
+            out.write_fixed(joint_space[j][i]);
 
             if (!(i == 3 && j == 3)) {
 
-                out = out + " ";
+                out << ' ';
             }
         }
     }
 
     //close matrix tag
-    out = out + "</matrix>\n";
+    out << "</matrix>\n";
 
     //recursively add child nodes
     for (int i = 0; i < children.size(); i++) {
 
-        out = out + children[i]->collada(depth+1, scale[0]*accum_scale);
+        children[i]->collada(out, depth+1, scale[0]*accum_scale);
     }
 
     //specify bone details for blender
     //bones are not connected to allow translation (e.g. Electromagnetic Bagworm death animation)
-    out = out + spacing + "  <extra>\n"
-              + spacing + "    <technique profile=\"blender\">\n"
-              + spacing + "      <connect sid=\"connect\" type=\"bool\">0</connect>\n";
-    
+    out << spacing << "  <extra>\n"
+        << spacing << "    <technique profile=\"blender\">\n"
+        << spacing << "      <connect sid=\"connect\" type=\"bool\">0</connect>\n";
+
     if (children.size() > 0) {
 
         Joint *joint;
@@ -444,7 +439,7 @@ std::string Joint::collada(int depth, double accum_scale) {
         double y_val;
         double z_val;
 
-        //connect bone to first child joint with non-zero offset, and return finished string
+        //connect bone to first child joint with non-zero offset, and finish the node
         for (int i = 0; i < children.size(); i++) {
 
             if (children[i]->position[0] != 0 || children[i]->position[1] != 0 || children[i]->position[2] != 0) {
@@ -459,127 +454,128 @@ std::string Joint::collada(int depth, double accum_scale) {
                 //if none of the potential connections are long enough, the default is used instead
                 if (x_val*x_val + y_val*y_val + z_val*z_val > 1) {
 
-                    return out + spacing + "      <layer sid=\"layer\" type=\"string\">0</layer>\n"
-                            + spacing + "      <tip_x sid=\"tip_x\" type=\"float\">" + std::to_string(x_val) + "</tip_x>\n"
-                            + spacing + "      <tip_y sid=\"tip_y\" type=\"float\">" + std::to_string(y_val) + "</tip_y>\n"
-                            + spacing + "      <tip_z sid=\"tip_z\" type=\"float\">" + std::to_string(z_val) + "</tip_z>\n"
-                            + spacing + "    </technique>\n"
-                            + spacing + "  </extra>\n"
-                            + spacing + "</node>\n";
+                    out << spacing << "      <layer sid=\"layer\" type=\"string\">0</layer>\n"
+                        << spacing << "      <tip_x sid=\"tip_x\" type=\"float\">";
+                    out.write_fixed(x_val);
+                    out << "</tip_x>\n"
+                        << spacing << "      <tip_y sid=\"tip_y\" type=\"float\">";
+                    out.write_fixed(y_val);
+                    out << "</tip_y>\n"
+                        << spacing << "      <tip_z sid=\"tip_z\" type=\"float\">";
+                    out.write_fixed(z_val);
+                    out << "</tip_z>\n"
+                        << spacing << "    </technique>\n"
+                        << spacing << "  </extra>\n"
+                        << spacing << "</node>\n";
+
+                    return;
                 }
             }
         }
     }
-    
+
     //default bone details for blender
-    out = out + spacing + "      <layer sid=\"layer\" type=\"string\">0</layer>\n"
-              + spacing + "      <tip_x sid=\"tip_x\" type=\"float\">0</tip_x>\n"
-              + spacing + "      <tip_y sid=\"tip_y\" type=\"float\">-1</tip_y>\n"
-              + spacing + "      <tip_z sid=\"tip_z\" type=\"float\">0</tip_z>\n"
-              + spacing + "    </technique>\n"
-              + spacing + "  </extra>\n";
-
-    //close node tag and return out string
-    return out + spacing + "</node>\n";
+    out << spacing << "      <layer sid=\"layer\" type=\"string\">0</layer>\n"
+        << spacing << "      <tip_x sid=\"tip_x\" type=\"float\">0</tip_x>\n"
+        << spacing << "      <tip_y sid=\"tip_y\" type=\"float\">-1</tip_y>\n"
+        << spacing << "      <tip_z sid=\"tip_z\" type=\"float\">0</tip_z>\n"
+        << spacing << "    </technique>\n"
+        << spacing << "  </extra>\n";
+
+    //close node tag
+    out << spacing << "</node>\n";
 }
 
-std::string Joint::animation_collada() {
-
-    //store order as string
-    std::string order_string = std::to_string(order);
-
-    std::string out;
+void Joint::animation_collada(TextBuffer &out) {
 
     if (animation_frames.size() > 0) {
 
         //write time values
-        out = "    <animation id=\"anim-" + order_string + "\">\n"
-            "      <source id=\"anim-" + order_string + "-input\">\n"
-            "        <float_array id=\"anim-" + order_string + "-input-array\" count=\"" + std::to_string(animation_frames.size()) + "\">";
-        
+        out << "    <animation id=\"anim-" << order << "\">\n"
+               "      <source id=\"anim-" << order << "-input\">\n"
+               "        <float_array id=\"anim-" << order << "-input-array\" count=\"" << animation_frames.size() << "\">";
+
         for (int i = 0; i < animation_frames.size(); i++) {
 
-            out = out + std::to_string(static_cast<double>(animation_frames[i])/30.0);
+            out.write_fixed(static_cast<double>(animation_frames[i])/30.0);
 
             if (i != animation_frames.size()-1) {
 
-                out = out + " ";
+                out << ' ';
             }
         }
 
         //write transformation matrices
-        out = out + "</float_array>\n"
-                    "        <technique_common>\n"
-                    "          <accessor source=\"#anim-" + order_string + "-input-array\" count=\"" + std::to_string(animation_frames.size()) + "\" stride=\"1\">\n"
-                    "            <param name=\"TIME\" type=\"float\"/>\n"
-                    "          </accessor>\n"
-                    "        </technique_common>\n"
-                    "      </source>\n"
-                    "      <source id=\"anim-" + order_string + "-transform\">\n"
-                    "        <float_array id=\"anim-" + order_string + "-transform-array\" count=\"" + std::to_string(16*animation_matrices.size()) + "\">";
-        
+        out << "</float_array>\n"
+               "        <technique_common>\n"
+               "          <accessor source=\"#anim-" << order << "-input-array\" count=\"" << animation_frames.size() << "\" stride=\"1\">\n"
+               "            <param name=\"TIME\" type=\"float\"/>\n"
+               "          </accessor>\n"
+               "        </technique_common>\n"
+               "      </source>\n"
+               "      <source id=\"anim-" << order << "-transform\">\n"
+               "        <float_array id=\"anim-" << order << "-transform-array\" count=\"" << 16*animation_matrices.size() << "\">";
+
         for (int i = 0; i < animation_matrices.size(); i++) {
 
             for (int j = 0; j < 16; j++) {
 
-                out = out + std::to_string(animation_matrices[i][j]);
+                out.write_fixed(animation_matrices[i][j]);
 
                 if (j != 15) {
 
-                    out = out + " ";
+                    out << ' ';
                 }
             }
 
             if (i != animation_matrices.size()-1) {
 
-                out = out + " ";
+                out << ' ';
             }
         }
 
         //write interpolation
-        out = out + "</float_array>\n"
-                    "        <technique_common>\n"
-                    "          <accessor source=\"#anim-" + order_string + "-transform-array\" count=\"" + std::to_string(animation_matrices.size()) + "\" stride=\"16\">\n"
-                    "            <param name=\"TRANSFORM\" type=\"float4x4\"/>\n"
-                    "          </accessor>\n"
-                    "        </technique_common>\n"
-                    "      </source>\n"
-                    "      <source id=\"anim-" + order_string + "-interpolation\">\n"
-                    "        <Name_array id=\"anim-" + order_string + "-interpolation-array\" count=\"" + std::to_string(animation_frames.size()) + "\">";
-    
+        out << "</float_array>\n"
+               "        <technique_common>\n"
+               "          <accessor source=\"#anim-" << order << "-transform-array\" count=\"" << animation_matrices.size() << "\" stride=\"16\">\n"
+               "            <param name=\"TRANSFORM\" type=\"float4x4\"/>\n"
+               "          </accessor>\n"
+               "        </technique_common>\n"
+               "      </source>\n"
+               "      <source id=\"anim-" << order << "-interpolation\">\n"
+               "        <Name_array id=\"anim-" << order << "-interpolation-array\" count=\"" << animation_frames.size() << "\">";
+
         for (int i = 0; i < animation_frames.size(); i++) {
 
-            out = out + "LINEAR";
+            out << "LINEAR";
 
             if (i != animation_frames.size()-1) {
 
-                out = out + " ";
+                out << ' ';
             }
         }
 
-        out = out + "</Name_array>\n"
-                    "        <technique_common>\n"
-                    "          <accessor source=\"#anim-" + order_string + "-interpolation-array\" count=\"" + std::to_string(animation_frames.size()) + "\" stride=\"1\">\n"
-                    "            <param name=\"INTERPOLATION\" type=\"Name\"/>\n"
-                    "          </accessor>\n"
-                    "        </technique_common>\n"
-                    "      </source>\n"
-                    "      <sampler id=\"anim-" + order_string + "-sampler\">\n"
-                    "        <input semantic=\"INPUT\" source=\"#anim-" + order_string + "-input\"/>\n"
-                    "        <input semantic=\"OUTPUT\" source=\"#anim-" + order_string + "-transform\"/>\n"
-                    "        <input semantic=\"INTERPOLATION\" source=\"#anim-" + order_string + "-interpolation\"/>\n"
-                    "      </sampler>\n"
-                    "      <channel source=\"#anim-" + order_string + "-sampler\" target=\"joint_" + order_string + "/transform\"/>\n"
-                    "    </animation>\n";
+        out << "</Name_array>\n"
+               "        <technique_common>\n"
+               "          <accessor source=\"#anim-" << order << "-interpolation-array\" count=\"" << animation_frames.size() << "\" stride=\"1\">\n"
+               "            <param name=\"INTERPOLATION\" type=\"Name\"/>\n"
+               "          </accessor>\n"
+               "        </technique_common>\n"
+               "      </source>\n"
+               "      <sampler id=\"anim-" << order << "-sampler\">\n"
+               "        <input semantic=\"INPUT\" source=\"#anim-" << order << "-input\"/>\n"
+               "        <input semantic=\"OUTPUT\" source=\"#anim-" << order << "-transform\"/>\n"
+               "        <input semantic=\"INTERPOLATION\" source=\"#anim-" << order << "-interpolation\"/>\n"
+               "      </sampler>\n"
+               "      <channel source=\"#anim-" << order << "-sampler\" target=\"joint_" << order << "/transform\"/>\n"
+               "    </animation>\n";
     }
-    
-    //get child animations
+
+    //write child animations
     for (int i = 0; i < children.size(); i++) {
 
-        out = out + children[i]->animation_collada();
+        children[i]->animation_collada(out);
     }
-
-    return out;
 }
 
 void Joint::update_local() {
@@ -1,5 +1,6 @@
 #include <vector>
 #include <string>
+#include "TextBuffer.h"
 
 #ifndef JOINT_H
 #define JOINT_H
@@ -33,14 +34,14 @@ public:
     //transforms vector according to world_space matrix
     std::vector<double> transform_vector(std::vector<double> vertex);
 
-    //recursively output collada pose array
-    std::string pose_collada();
+    //recursively write collada pose array to out
+    void pose_collada(TextBuffer &out);
 
-    //recursively output collada xml
-    std::string collada(int depth, double accum_scale);
+    //recursively write collada xml to out
+    void collada(TextBuffer &out, int depth, double accum_scale);
 
-    //recursively output collada joint animations
-    std::string animation_collada();
+    //recursively write collada joint animations to out
+    void animation_collada(TextBuffer &out);
 
     //declaring Skeleton and ModelRipper as friend classes
     friend class Skeleton;
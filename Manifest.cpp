@@ -0,0 +1,72 @@
+#include "Manifest.h"
+#include "OutFile.h"
+#include "TextBuffer.h"
+#include<fstream>
+#include<map>
+#include<sstream>
+#include<string>
+
+//first line of every manifest file
+const std::string MANIFEST_HEADER = "dotr-model-ripper manifest 1";
+
+bool Manifest::load(std::string path) {
+
+    entries.clear();
+
+    std::ifstream manifest_file(path);
+
+    std::string line;
+
+    if (!std::getline(manifest_file, line) || line != MANIFEST_HEADER) return false;
+
+    while (std::getline(manifest_file, line)) {
+
+        std::istringstream fields(line);
+
+        int monster;
+        std::string output;
+        std::string hash;
+        std::string settings;
+
+        if (fields >> monster >> output >> hash >> settings) {
+
+            entries[std::make_pair(monster, output)] = std::make_pair(hash, settings);
+        }
+    }
+
+    return true;
+}
+
+void Manifest::save(OutputTarget &target, std::string path) {
+
+    OutFile manifest_file(target, path);
+
+    TextBuffer manifest(manifest_file);
+
+    manifest << MANIFEST_HEADER << "\n";
+
+    for (std::map<std::pair<int, std::string>, std::pair<std::string, std::string>>::iterator it = entries.begin(); it != entries.end(); it++) {
+
+        manifest << it->first.first << " " << it->first.second << " " << it->second.first << " " << it->second.second << "\n";
+    }
+
+    manifest_file.close();
+}
+
+bool Manifest::up_to_date(int monster, std::string output, std::string hash, std::string settings) {
+
+    std::map<std::pair<int, std::string>, std::pair<std::string, std::string>>::iterator it = entries.find(std::make_pair(monster, output));
+
+    return it != entries.end() && it->second.first == hash && it->second.second == settings;
+}
+
+void Manifest::record(int monster, std::string output, std::string hash, std::string settings) {
+
+    entries[std::make_pair(monster, output)] = std::make_pair(hash, settings);
+}
+
+void Manifest::forget(int monster) {
+
+    //entries are sorted by monster first
+    entries.erase(entries.lower_bound(std::make_pair(monster, std::string())), entries.lower_bound(std::make_pair(monster + 1, std::string())));
+}
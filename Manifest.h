@@ -0,0 +1,39 @@
+#include<map>
+#include<string>
+#include "OutputTarget.h"
+
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+//record of the outputs produced for each monster, used to skip monsters which have not changed since the last run
+//
+//manifest files are text, with one line for each output of each monster:
+//<monster id> <output name> <hash of monster data> <settings>
+//settings holds the output version of the ripper and the options which affect the output, and never contains spaces
+class Manifest {
+
+public:
+
+    //reads entries from the manifest file at path
+    //returns false if the file does not exist or is not a manifest, leaving the manifest empty
+    bool load(std::string path);
+
+    //writes all entries to a manifest file at path in target
+    void save(OutputTarget &target, std::string path);
+
+    //returns true if output of monster was produced from data with hash using settings
+    bool up_to_date(int monster, std::string output, std::string hash, std::string settings);
+
+    //records that output of monster was produced from data with hash using settings
+    void record(int monster, std::string output, std::string hash, std::string settings);
+
+    //removes every output of monster, so that all of them are produced again by the next run
+    void forget(int monster);
+
+private:
+
+    //hash and settings of each output, by monster and output name
+    std::map<std::pair<int, std::string>, std::pair<std::string, std::string>> entries;
+};
+
+#endif
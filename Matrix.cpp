@@ -0,0 +1,182 @@
+#include "Matrix.h"
+#include<math.h>
+#include<vector>
+
+void Matrix::decompose(const std::vector<double> &matrix, double *translation, double *rotation, double *scale) {
+
+    //rotation matrix with scaling removed
+    double rot[3][3];
+
+    //translation is stored in the last column
+    translation[0] = matrix[3];
+    translation[1] = matrix[7];
+    translation[2] = matrix[11];
+
+    //scale along each axis is the length of the matching column
+    for (int i = 0; i < 3; i++) {
+
+        scale[i] = sqrt(matrix[i]*matrix[i] + matrix[4 + i]*matrix[4 + i] + matrix[8 + i]*matrix[8 + i]);
+    }
+
+    //reflections are stored as a negative x scale
+    double det = matrix[0]*(matrix[5]*matrix[10] - matrix[6]*matrix[9])
+               - matrix[1]*(matrix[4]*matrix[10] - matrix[6]*matrix[8])
+               + matrix[2]*(matrix[4]*matrix[9] - matrix[5]*matrix[8]);
+
+    if (det < 0) {
+
+        scale[0] = -scale[0];
+    }
+
+    for (int i = 0; i < 3; i++) {
+
+        for (int j = 0; j < 3; j++) {
+
+            if (scale[j] == 0) {
+
+                rot[i][j] = (i == j) ? 1 : 0;
+
+            } else {
+
+                rot[i][j] = matrix[4*i + j]/scale[j];
+            }
+        }
+    }
+
+    //convert rotation matrix to quaternion, using the largest diagonal term for accuracy
+    double trace = rot[0][0] + rot[1][1] + rot[2][2];
+    double s;
+
+    if (trace > 0) {
+
+        s = 2*sqrt(trace + 1);
+
+        rotation[0] = (rot[2][1] - rot[1][2])/s;
+        rotation[1] = (rot[0][2] - rot[2][0])/s;
+        rotation[2] = (rot[1][0] - rot[0][1])/s;
+        rotation[3] = 0.25*s;
+
+    } else if (rot[0][0] > rot[1][1] && rot[0][0] > rot[2][2]) {
+
+        s = 2*sqrt(1 + rot[0][0] - rot[1][1] - rot[2][2]);
+
+        rotation[0] = 0.25*s;
+        rotation[1] = (rot[0][1] + rot[1][0])/s;
+        rotation[2] = (rot[0][2] + rot[2][0])/s;
+        rotation[3] = (rot[2][1] - rot[1][2])/s;
+
+    } else if (rot[1][1] > rot[2][2]) {
+
+        s = 2*sqrt(1 + rot[1][1] - rot[0][0] - rot[2][2]);
+
+        rotation[0] = (rot[0][1] + rot[1][0])/s;
+        rotation[1] = 0.25*s;
+        rotation[2] = (rot[1][2] + rot[2][1])/s;
+        rotation[3] = (rot[0][2] - rot[2][0])/s;
+
+    } else {
+
+        s = 2*sqrt(1 + rot[2][2] - rot[0][0] - rot[1][1]);
+
+        rotation[0] = (rot[0][2] + rot[2][0])/s;
+        rotation[1] = (rot[1][2] + rot[2][1])/s;
+        rotation[2] = 0.25*s;
+        rotation[3] = (rot[1][0] - rot[0][1])/s;
+    }
+
+    //normalise quaternion, which may be slightly off when the matrix contains shear
+    double magnitude = sqrt(rotation[0]*rotation[0] + rotation[1]*rotation[1] + rotation[2]*rotation[2] + rotation[3]*rotation[3]);
+
+    for (int i = 0; i < 4; i++) {
+
+        rotation[i] /= magnitude;
+    }
+}
+
+std::vector<double> Matrix::compose(const double *translation, const double *rotation, const double *scale) {
+
+    std::vector<double> matrix(16, 0);
+
+    double x = rotation[0];
+    double y = rotation[1];
+    double z = rotation[2];
+    double w = rotation[3];
+
+    //rotation matrix multiplied by scale
+    matrix[0] = (1 - 2*(y*y + z*z))*scale[0];
+    matrix[1] = 2*(x*y - z*w)*scale[1];
+    matrix[2] = 2*(x*z + y*w)*scale[2];
+
+    matrix[4] = 2*(x*y + z*w)*scale[0];
+    matrix[5] = (1 - 2*(x*x + z*z))*scale[1];
+    matrix[6] = 2*(y*z - x*w)*scale[2];
+
+    matrix[8] = 2*(x*z - y*w)*scale[0];
+    matrix[9] = 2*(y*z + x*w)*scale[1];
+    matrix[10] = (1 - 2*(x*x + y*y))*scale[2];
+
+    //translation in last column
+    matrix[3] = translation[0];
+    matrix[7] = translation[1];
+    matrix[11] = translation[2];
+
+    matrix[15] = 1;
+
+    return matrix;
+}
+
+std::vector<double> Matrix::multiply(const std::vector<double> &a, const std::vector<double> &b) {
+
+    std::vector<double> matrix(16, 0);
+
+    for (int i = 0; i < 4; i++) {
+
+        for (int j = 0; j < 4; j++) {
+
+            for (int k = 0; k < 4; k++) {
+
+                matrix[4*i + j] += a[4*i + k]*b[4*k + j];
+            }
+        }
+    }
+
+    return matrix;
+}
+
+std::vector<double> Matrix::invert(const std::vector<double> &m) {
+
+    std::vector<double> matrix(16, 0);
+
+    //adjugate of the 3x3 submatrix
+    matrix[0] = m[5]*m[10] - m[6]*m[9];
+    matrix[1] = m[2]*m[9] - m[1]*m[10];
+    matrix[2] = m[1]*m[6] - m[2]*m[5];
+
+    matrix[4] = m[6]*m[8] - m[4]*m[10];
+    matrix[5] = m[0]*m[10] - m[2]*m[8];
+    matrix[6] = m[2]*m[4] - m[0]*m[6];
+
+    matrix[8] = m[4]*m[9] - m[5]*m[8];
+    matrix[9] = m[1]*m[8] - m[0]*m[9];
+    matrix[10] = m[0]*m[5] - m[1]*m[4];
+
+    double det = m[0]*matrix[0] + m[1]*matrix[4] + m[2]*matrix[8];
+
+    for (int i = 0; i < 3; i++) {
+
+        for (int j = 0; j < 3; j++) {
+
+            matrix[4*i + j] /= det;
+        }
+    }
+
+    //translation equals the negative of the inverse submatrix multiplied by the original translation
+    for (int i = 0; i < 3; i++) {
+
+        matrix[4*i + 3] = -(matrix[4*i]*m[3] + matrix[4*i + 1]*m[7] + matrix[4*i + 2]*m[11]);
+    }
+
+    matrix[15] = 1;
+
+    return matrix;
+}
@@ -0,0 +1,27 @@
+#include<vector>
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+//operations on 4x4 transformation matrices, stored row by row in vectors of 16 values
+class Matrix {
+
+public:
+
+    //decomposes a transformation matrix into translation, rotation quaternion (x, y, z, w), and scale
+    //matrix is a column vector transformation stored row by row, the layout used by animation matrices
+    //any shear in the matrix is lost
+    static void decompose(const std::vector<double> &matrix, double *translation, double *rotation, double *scale);
+
+    //builds a transformation matrix from translation, rotation quaternion (x, y, z, w), and scale
+    //matrix is a column vector transformation stored row by row, the layout used by animation matrices
+    static std::vector<double> compose(const double *translation, const double *rotation, const double *scale);
+
+    //multiplies two transformation matrices stored row by row
+    static std::vector<double> multiply(const std::vector<double> &a, const std::vector<double> &b);
+
+    //inverts a transformation matrix stored row by row, assuming the bottom row is 0 0 0 1
+    static std::vector<double> invert(const std::vector<double> &m);
+};
+
+#endif
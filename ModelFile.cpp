@@ -0,0 +1,200 @@
+#include "ModelFile.h"
+#include "OutFile.h"
+#include<cstddef>
+#include<cstring>
+#include<string>
+#include<vector>
+
+#ifdef _WIN32
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+void ModelFileWriter::add(const char *tag, const char *data, size_t size, size_t count) {
+
+    ModelFileSection entry;
+
+    std::memcpy(entry.tag, tag, 4);
+
+    entry.count = count;
+    entry.offset = section_data.size();
+    entry.size = size;
+
+    sections.push_back(entry);
+
+    //pad section to a 16 byte boundary
+    section_data.insert(section_data.end(), data, data + size);
+    section_data.resize((section_data.size() + 15)/16*16, 0);
+}
+
+void ModelFileWriter::write(std::string path) {
+
+    //size of header and section table, rounded up so that the first section is aligned
+    size_t header_size = (16 + sizeof(ModelFileSection)*sections.size() + 15)/16*16;
+
+    std::vector<char> header(header_size, 0);
+
+    const char identifier[4] = {'D', 'M', 'F', '1'};
+
+    unsigned int version = 1;
+    unsigned int n_sections = sections.size();
+
+    std::memcpy(header.data(), identifier, 4);
+    std::memcpy(header.data() + 0x04, &version, 4);
+    std::memcpy(header.data() + 0x08, &n_sections, 4);
+
+    //section offsets are measured from the start of the file
+    for (int i = 0; i < sections.size(); i++) {
+
+        ModelFileSection entry = sections[i];
+
+        entry.offset += header_size;
+
+        std::memcpy(header.data() + 16 + sizeof(ModelFileSection)*i, &entry, sizeof(ModelFileSection));
+    }
+
+    OutFile DMF_file(path);
+
+    DMF_file.write(header.data(), header.size());
+    DMF_file.write(section_data.data(), section_data.size());
+
+    DMF_file.close();
+}
+
+ModelFileReader::~ModelFileReader() {
+
+    close();
+}
+
+bool ModelFileReader::open(std::string path) {
+
+    close();
+
+    //map whole file as read only
+    #ifdef _WIN32
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < 16) {
+
+        CloseHandle(file);
+
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    //the view keeps the file mapped after the handles are closed
+    if (mapping != nullptr) {
+
+        base = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+        CloseHandle(mapping);
+    }
+
+    CloseHandle(file);
+
+    if (base == nullptr) return false;
+
+    size = file_size.QuadPart;
+
+    #else
+
+    int file = ::open(path.c_str(), O_RDONLY);
+
+    if (file < 0) return false;
+
+    struct stat file_stat;
+
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size < 16) {
+
+        ::close(file);
+
+        return false;
+    }
+
+    //the mapping stays valid after the file is closed
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    ::close(file);
+
+    if (mapped == MAP_FAILED) return false;
+
+    base = static_cast<const char *>(mapped);
+    size = file_stat.st_size;
+
+    #endif
+
+    //check header
+    unsigned int version;
+
+    std::memcpy(&version, base + 0x04, 4);
+    std::memcpy(&n_sections, base + 0x08, 4);
+
+    if (std::memcmp(base, "DMF1", 4) != 0 || version != 1 || n_sections > (size - 16)/sizeof(ModelFileSection)) {
+
+        close();
+
+        return false;
+    }
+
+    sections = reinterpret_cast<const ModelFileSection *>(base + 16);
+
+    //check that every section lies inside the file and is aligned
+    for (int i = 0; i < n_sections; i++) {
+
+        if (sections[i].offset%16 != 0 || sections[i].offset > size || sections[i].size > size - sections[i].offset) {
+
+            close();
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ModelFileReader::close() {
+
+    if (base == nullptr) return;
+
+    #ifdef _WIN32
+
+    UnmapViewOfFile(base);
+
+    #else
+
+    munmap(const_cast<char *>(base), size);
+
+    #endif
+
+    base = nullptr;
+    size = 0;
+    sections = nullptr;
+    n_sections = 0;
+}
+
+size_t ModelFileReader::count(const char *tag) const {
+
+    const ModelFileSection *entry = find(tag);
+
+    return (entry != nullptr) ? entry->count : 0;
+}
+
+const ModelFileSection *ModelFileReader::find(const char *tag) const {
+
+    for (int i = 0; i < n_sections; i++) {
+
+        if (std::memcmp(sections[i].tag, tag, 4) == 0) return &sections[i];
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,235 @@
+#include<cstddef>
+#include<cstring>
+#include<string>
+#include<vector>
+
+#ifndef MODELFILE_H
+#define MODELFILE_H
+
+//binary model container, designed to be memory mapped and used without parsing or copying
+//
+//all values are little endian, and every section starts on a 16 byte boundary
+//0x00  char[4]   identifier "DMF1"
+//0x04  uint32    version, currently 1
+//0x08  uint32    number of sections
+//0x0C  uint32    reserved, 0
+//0x10  section table, one ModelFileSection for each section
+//
+//sections, identified by tag:
+//"VPOS"  float[3]            bind pose position of each vertex
+//"VNRM"  float[3]            bind pose normal of each vertex
+//"VUV "  float[2]            uv of each vertex, starting at the bottom left of the texture
+//"FIDX"  uint32[3]           vertex indices of each face, starting at 0
+//"FMAT"  ModelFileFace       texture and flags of each face
+//"SKNO"  uint32              index of the first influence in "SKIN" of each vertex, followed by the total number of influences
+//"SKIN"  ModelFileInfluence  joint influences of every vertex
+//"JNTS"  ModelFileJoint      joints, in order, with each parent before its children
+//"FRMS"  uint32              frame number of each posed frame in the combined animation
+//"POSE"  float[16]           world matrix of every joint at each posed frame, joint j of frame f at index f*joints + j
+//"CLIP"  ModelFileClip       posed frames belonging to each animation clip
+//"TEXI"  ModelFileTexture    size of each texture and the location of its pixels
+//"TEXP"  uint32              pixels of every texture as 0xAARRGGBB, bottom row first, where an alpha of 0x80 is opaque
+//
+//matrices are stored row by row and transform column vectors, so the translation is in elements 3, 7, and 11
+//a posed vertex is the weighted sum of each influence's position transformed by its joint's world matrix
+//posed normals are the weighted sum of each influence's normal transformed by the inverse transpose of the upper 3x3 of the world matrix
+//this reproduces the meshes written by the frames format exactly
+
+//entry in the section table
+struct ModelFileSection {
+
+    //four character tag identifying the section
+    char tag[4];
+
+    //number of elements in section
+    unsigned int count;
+
+    //offset of section from start of file
+    unsigned long long offset;
+
+    //size of section in bytes
+    unsigned long long size;
+};
+
+//texture and flags of a face
+struct ModelFileFace {
+
+    //index of texture in "TEXI"
+    unsigned short int texture;
+
+    //1 if the face is transparent
+    unsigned short int flags;
+};
+
+//influence of a joint on a vertex
+struct ModelFileInfluence {
+
+    //index of joint in "JNTS"
+    unsigned int joint;
+
+    //weight of joint
+    float weight;
+
+    //position of vertex relative to joint
+    float position[3];
+
+    //normal of vertex relative to joint
+    float normal[3];
+};
+
+//joint in skeleton
+struct ModelFileJoint {
+
+    //bind pose transform relative to parent joint
+    float local[16];
+
+    //bind pose world transform
+    float world[16];
+
+    //index of parent joint, -1 for the root joint
+    int parent;
+
+    //id used to reference the joint in MONSTER.MRG
+    unsigned int id;
+
+    //reserved, 0
+    unsigned int reserved[2];
+};
+
+//range of posed frames in an animation clip
+struct ModelFileClip {
+
+    //index of first posed frame of clip in "FRMS"
+    unsigned int first;
+
+    //number of posed frames in clip
+    unsigned int count;
+};
+
+//texture stored in "TEXP"
+struct ModelFileTexture {
+
+    //width of texture in pixels
+    unsigned int width;
+
+    //height of texture in pixels
+    unsigned int height;
+
+    //index of the first pixel of the texture in "TEXP"
+    unsigned int first_pixel;
+
+    //reserved, 0
+    unsigned int reserved;
+};
+
+//read only view of an array inside a mapped file
+template <typename T>
+struct ModelFileArray {
+
+    const T *data = nullptr;
+
+    size_t size = 0;
+
+    const T &operator[](size_t i) const {
+
+        return data[i];
+    }
+
+    const T *begin() const {
+
+        return data;
+    }
+
+    const T *end() const {
+
+        return data + size;
+    }
+};
+
+//collects sections and writes them to a container file
+class ModelFileWriter {
+
+public:
+
+    //adds section with tag, holding count elements stored in items
+    template <typename T>
+    void add(const char *tag, const std::vector<T> &items, size_t count) {
+
+        add(tag, reinterpret_cast<const char *>(items.data()), sizeof(T)*items.size(), count);
+    }
+
+    //adds section with tag, holding count elements stored in size bytes of data
+    void add(const char *tag, const char *data, size_t size, size_t count);
+
+    //writes header, section table, and sections to a file at path in the default output target
+    void write(std::string path);
+
+private:
+
+    //table entries of added sections, with offsets relative to the start of section_data
+    std::vector<ModelFileSection> sections;
+
+    //data of added sections, padded to 16 byte boundaries
+    std::vector<char> section_data;
+};
+
+//maps a container file into memory and exposes its sections in place
+class ModelFileReader {
+
+public:
+
+    ModelFileReader() = default;
+
+    //unmaps the file
+    ~ModelFileReader();
+
+    ModelFileReader(const ModelFileReader &) = delete;
+    ModelFileReader &operator=(const ModelFileReader &) = delete;
+
+    //maps the file at path
+    //returns false if the file cannot be mapped or is not a valid container
+    bool open(std::string path);
+
+    //unmaps the file, invalidating all arrays returned by section
+    void close();
+
+    //returns the contents of the section with tag as an array of T
+    //returns an empty array if there is no such section or its size is not a multiple of T
+    template <typename T>
+    ModelFileArray<T> section(const char *tag) const {
+
+        ModelFileArray<T> array;
+
+        const ModelFileSection *entry = find(tag);
+
+        if (entry != nullptr && entry->size%sizeof(T) == 0) {
+
+            array.data = reinterpret_cast<const T *>(base + entry->offset);
+            array.size = entry->size/sizeof(T);
+        }
+
+        return array;
+    }
+
+    //returns number of elements in the section with tag, or 0 if there is no such section
+    size_t count(const char *tag) const;
+
+private:
+
+    //start of mapped file
+    const char *base = nullptr;
+
+    //size of mapped file
+    size_t size = 0;
+
+    //section table inside the mapped file
+    const ModelFileSection *sections = nullptr;
+
+    //number of entries in section table
+    unsigned int n_sections = 0;
+
+    //returns the table entry for tag, or nullptr if there is no such section
+    const ModelFileSection *find(const char *tag) const;
+};
+
+#endif
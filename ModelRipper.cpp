@@ -1,13 +1,23 @@
 #include<vector>
 #include<iostream>
-#include<fstream>
+#include<algorithm>
+#include<memory>
+#include<cstring>
 #include<math.h>
 #include<string>
 #include "Skeleton.h"
 #include "Joint.h"
 #include "ModelRipper.h"
 #include "TexRipper.h"
-#include "MonsterList.h"
+#include "TextBuffer.h"
+#include "OutFile.h"
+#include "OutputTarget.h"
+#include "FrameStream.h"
+#include "ModelFile.h"
+#include "PngEncoder.h"
+#include "Hash.h"
+#include "Glb.h"
+#include "Matrix.h"
 
 //struct for extracting monster header info
 struct mon_header {
@@ -201,6 +211,92 @@ void sort(std::vector<int> *offsets, std::vector<int> *ids) {
     }
 }
 
+//writes a vertex animation texture with 3 channels, values holds the rows from top to bottom
+//pfm files store values directly, png files store 16 bit values scaled so that minimum is 0 and maximum is 65535
+void write_vat_image(std::string path, int width, int height, const std::vector<float> &values, bool float_image, const float *minimum, const float *maximum) {
+
+    OutFile VAT_file(path);
+
+    if (float_image) {
+
+        //pfm header, negative scale means little endian
+        std::string header = "PF\n" + std::to_string(width) + " " + std::to_string(height) + "\n-1.0\n";
+
+        VAT_file.write(header.data(), header.size());
+
+        //pfm stores the bottom row first
+        for (int i = height - 1; i >= 0; i--) {
+
+            VAT_file.write(reinterpret_cast<const char *>(values.data() + 3*i*width), 12*width);
+        }
+
+    } else {
+
+        //16 bit samples stored big endian
+        std::vector<unsigned char> rows(6*width*height);
+
+        for (int i = 0; i < 3*width*height; i++) {
+
+            //range of current channel
+            float range = maximum[i%3] - minimum[i%3];
+
+            long sample = (range > 0) ? std::lround((values[i] - minimum[i%3])/range*65535.0f) : 0;
+
+            if (sample < 0) {
+
+                sample = 0;
+
+            } else if (sample > 65535) {
+
+                sample = 65535;
+            }
+
+            rows[2*i] = sample >> 8;
+            rows[2*i + 1] = sample & 0xFF;
+        }
+
+        std::vector<char> png;
+
+        PngEncoder::encode(width, height, PngEncoder::RGB, 16, rows, png, true);
+
+        VAT_file.write(png.data(), png.size());
+    }
+
+    VAT_file.close();
+}
+
+//region of a texture atlas holding the repeats of one texture
+struct atlas_tile {
+
+    //texture copied into the tile, starting at 0
+    int texture;
+
+    //first period of the texture in each direction, and the number of periods, covering the uvs of every vertex using the texture
+    int first_u;
+    int first_v;
+    int repeats_u;
+    int repeats_v;
+
+    //size of the tile including its border, in pixels
+    int width;
+    int height;
+
+    //position of the tile in the atlas, in pixels
+    int x;
+    int y;
+};
+
+//returns the pixel of a texture of the given size read at coordinate, when the texture is repeated with every other copy mirrored
+int mirror_coordinate(int coordinate, int size) {
+
+    //position within a pair of copies, the second of which is mirrored
+    int position = coordinate%(2*size);
+
+    if (position < 0) position += 2*size;
+
+    return (position < size) ? position : 2*size - 1 - position;
+}
+
 //initialise static variables
 
 //skeleton used by model
@@ -221,6 +317,21 @@ std::vector<std::vector<int>> ModelRipper::vertex_bones;
 //vector of vectors of weights for each bone in vertex_bones
 std::vector<std::vector<double>> ModelRipper::vertex_weights;
 
+//vector of vectors of pointers to the joint for each bone in vertex_bones
+std::vector<std::vector<Joint *>> ModelRipper::vertex_joints;
+
+//untransformed position of each vertex relative to each joint in vertex_joints
+std::vector<std::vector<double>> ModelRipper::vertex_local_positions;
+
+//untransformed normal of each vertex relative to each joint in vertex_joints
+std::vector<std::vector<double>> ModelRipper::vertex_local_normals;
+
+//vector of vertices in model at the currently posed frame
+std::vector<std::vector<double>> ModelRipper::posed_vertices;
+
+//vector of vertex normals in model at the currently posed frame
+std::vector<std::vector<double>> ModelRipper::posed_normals;
+
 //vector of faces in model
 std::vector<std::vector<int>> ModelRipper::faces;
 
@@ -230,6 +341,27 @@ std::vector<int> ModelRipper::face_textures;
 //transparency flag for each face
 std::vector<bool> ModelRipper::face_transparency;
 
+//decoded textures used by model
+std::vector<std::shared_ptr<const TexImage>> ModelRipper::textures;
+
+//hash of the texture block of each texture used by model
+std::vector<unsigned long long> ModelRipper::texture_hashes;
+
+//decoded textures by hash
+std::map<unsigned long long, std::shared_ptr<const TexImage>> ModelRipper::texture_cache;
+
+//hashes in texture_cache, oldest first
+std::deque<unsigned long long> ModelRipper::texture_cache_order;
+
+//total size of pixel and index data in texture_cache
+size_t ModelRipper::texture_cache_used = 0;
+
+//maximum size of pixel and index data in texture_cache
+const size_t ModelRipper::TEXTURE_CACHE_SIZE;
+
+//texture files written during the run
+TextureRegistry ModelRipper::texture_registry;
+
 //vector of pointers to joints used in mesh region
 std::vector<Joint *> ModelRipper::joints_in_use;
 
@@ -248,6 +380,9 @@ int ModelRipper::curr_tex = 0;
 //true while transparent mesh is being extracted
 bool ModelRipper::use_transparency = false;
 
+//format of texture files
+int ModelRipper::texture_format = TexRipper::BMP;
+
 //true if face orientation should be propagated across strip
 bool ModelRipper::propagate_order = false;
 
@@ -286,567 +421,2147 @@ void ModelRipper::rip(char *buf, int base) {
                      head->tex_offset);
 }
 
-void ModelRipper::animations_as_obj(char *buf, int base, std::string dest, std::string name) {
-
-    //get header info
-    mon_header *head = reinterpret_cast<mon_header *>(buf + base);
+void ModelRipper::animations_as_obj(std::string dest, std::string name, bool shared_topology, bool write_normals) {
 
     for (int i = 0; i < model_skeleton.root->animation_frames.size(); i++) {
 
-        //reset variables used by get_mesh_via_map
-        vertices.clear();
-        vertex_normals.clear();
-        vertex_uvs.clear();
-        vertex_bones.clear();
-        vertex_weights.clear();
-        faces.clear();
-        face_textures.clear();
-        face_transparency.clear();
-        joints_in_use.clear();
-        joint_refs.clear();
-        vertex_counter = 1;
-        texture_count = 0;
-        curr_tex = 0;
-        use_transparency = false;
-        propagate_order = false;
-        propagate_previous = 0;
-
-        //update skeleton to match the ith frame of animations
-        model_skeleton.set_frame(model_skeleton.root->animation_frames[i]);
-
-        //extract mesh corresponding to skeleton's current state
-        get_mesh_via_map(buf, base, 
-                         head->map_offset, head->mesh_offset, 
-                         head->t_map_offset, head->t_mesh_offset, 
-                         head->tex_list_offset, head->tex_map_offset, 
-                         head->tex_t_map_offset, head->tex_region_map_offset, 
-                         head->tex_offset);
+        //pose mesh to match the ith frame of animations
+        pose_mesh(model_skeleton.root->animation_frames[i]);
 
         //export mesh to obj file
-        to_obj(dest, name, model_skeleton.root->animation_frames[i]);
+        if (shared_topology) {
+
+            to_obj_vertices(dest, name, model_skeleton.root->animation_frames[i], write_normals);
+
+        } else {
+
+            to_obj(dest, name, model_skeleton.root->animation_frames[i]);
+        }
     }
-}
 
-void ModelRipper::generate_mtl(std::string dest, std::string name) {
+    //return skeleton to bind pose so that other exporters can still be used
+    model_skeleton.set_bind_pose();
+}
 
-    //create mtl file
-    std::ofstream MTL(dest + name + ".mtl", std::ios::trunc);
+void ModelRipper::animations_as_pc2(std::string dest, std::string name, bool write_normals) {
 
-    //count number of textures used
-    int n_tex = 0;
+    //frames of root joint, all joints share the same frames
+    std::vector<int> &frames = model_skeleton.root->animation_frames;
 
-    for (int i = 0; i < faces.size(); i++) {
+    for (int i = 0; i < model_skeleton.clip_starts.size(); i++) {
 
-        if (face_textures[i] > n_tex) {
+        //frames belonging to the current clip
+        std::vector<int> clip_frames;
 
-            n_tex = face_textures[i];
-        }
-    }
+        for (int j = 0; j < frames.size(); j++) {
 
-    //write materials
-    for (int i = 0; i < n_tex; i++) {
+            if (frames[j] >= model_skeleton.clip_starts[i] && frames[j] < model_skeleton.clip_starts[i] + model_skeleton.clip_lengths[i]) {
 
-        //ordinary material
-        //requires alpha clipping for transparency < 0.5
-        MTL << "newmtl tex." << i+1 << "\n";
-        MTL << "Ns 0.000000\n"
-        "Ka 1.000000 1.000000 1.000000\n"
-        "Ks 1.000000 1.000000 1.000000\n"
-        "Ke 0.000000 0.000000 0.000000\n"
-        "Ni 1.500000\n"
-        "illum 2\n";
-        MTL << "map_Kd " << name << "_" << i << ".bmp\n";
-        MTL << "map_d " << name << "_" << i << ".bmp\n";
-        MTL << "\n";
+                clip_frames.push_back(frames[j]);
+            }
+        }
 
-        //transparent material
-        MTL << "newmtl tex_t." << i+1 << "\n";
-        MTL << "Ns 0.000000\n"
-        "Ka 1.000000 1.000000 1.000000\n"
-        "Ks 1.000000 1.000000 1.000000\n"
-        "Ke 0.000000 0.000000 0.000000\n"
-        "Ni 1.500000\n"
-        "illum 2\n";
-        MTL << "map_Kd " << name << "_" << i << ".bmp\n";
-        MTL << "map_d " << name << "_" << i << ".bmp\n"; 
-        MTL << "\n";
-    }
+        if (clip_frames.size() == 0) continue;
 
-    //close file
-    MTL.close();
-}
+        //create point cache files
+        OutFile PC2_file(dest + name + " clip " + std::to_string(i) + ".pc2");
+        OutFile *normal_file = nullptr;
 
-void ModelRipper::to_obj(std::string dest, std::string name, int frame) {
+        if (write_normals) {
 
-    std::ofstream OBJ;
+            normal_file = new OutFile(dest + name + " clip " + std::to_string(i) + " normals.pc2");
+        }
 
-    //create obj file
-    if (frame >= 0) {
+        //pc2 header: identifier, version, number of points, start frame, sample rate, number of samples
+        char header[32] = "POINTCACHE2";
+        int version = 1;
+        int n_points = vertices.size();
+        float start_frame = 0;
+        float sample_rate = 1;
+        int n_samples = clip_frames.size();
 
-        OBJ = std::ofstream(dest + name + " frame " + std::to_string(frame) + ".obj", std::ios::trunc);
+        std::memcpy(header + 12, &version, 4);
+        std::memcpy(header + 16, &n_points, 4);
+        std::memcpy(header + 20, &start_frame, 4);
+        std::memcpy(header + 24, &sample_rate, 4);
+        std::memcpy(header + 28, &n_samples, 4);
 
-    } else {
+        PC2_file.write(header, 32);
 
-        OBJ = std::ofstream(dest + name + ".obj", std::ios::trunc);
-    }
+        if (write_normals) {
 
-    //declare mtl library
-    OBJ << "mtllib " + name << ".mtl\n";
+            normal_file->write(header, 32);
+        }
 
-    //write vertices
-    for (int i = 0; i < vertices.size(); i++) {
+        //write positions for each frame as 32 bit floats
+        for (int j = 0; j < clip_frames.size(); j++) {
 
-        OBJ << "v " << vertices[i][0] << " " << vertices[i][1] << " " << vertices[i][2] << "\n";
-    }
+            pose_mesh(clip_frames[j]);
 
-    //write uvs
-    for (int i = 0; i < vertex_uvs.size(); i++) {
+            float *sample = reinterpret_cast<float *>(PC2_file.reserve(12*n_points));
 
-        OBJ << "vt " << vertex_uvs[i][0] << " " << vertex_uvs[i][1] << "\n";
-    }
+            for (int k = 0; k < n_points; k++) {
 
-    //write vertex normals
-    for (int i = 0; i < vertex_normals.size(); i++) {
+                sample[3*k] = posed_vertices[k][0];
+                sample[3*k + 1] = posed_vertices[k][1];
+                sample[3*k + 2] = posed_vertices[k][2];
+            }
 
-        OBJ << "vn " << vertex_normals[i][0] << " " << vertex_normals[i][1] << " " << vertex_normals[i][2] << "\n";
-    }
-    
-    //write faces
-    for (int i = 0; i < faces.size(); i++) {
+            PC2_file.commit(12*n_points);
 
-        //change texture
-        if (i == 0) {
+            if (write_normals) {
 
-            if (face_transparency[i]) {
+                sample = reinterpret_cast<float *>(normal_file->reserve(12*n_points));
 
-                OBJ << "usemtl tex_t." << face_textures[i] << "\n";
-            
-            } else {
-                
-                OBJ << "usemtl tex." << face_textures[i] << "\n";
-            }
-        
-        } else if (face_textures[i] != face_textures[i-1] || face_transparency[i] != face_transparency[i-1]) {
+                for (int k = 0; k < n_points; k++) {
 
-            if (face_transparency[i]) {
+                    sample[3*k] = posed_normals[k][0];
+                    sample[3*k + 1] = posed_normals[k][1];
+                    sample[3*k + 2] = posed_normals[k][2];
+                }
 
-                OBJ << "usemtl tex_t." << face_textures[i] << "\n";
-            
-            } else {
-                
-                OBJ << "usemtl tex." << face_textures[i] << "\n";
+                normal_file->commit(12*n_points);
             }
         }
 
-        OBJ << "f ";
-        OBJ << faces[i][0] << "/" << faces[i][0] << "/" << faces[i][0] << " ";
-        OBJ << faces[i][1] << "/" << faces[i][1] << "/" << faces[i][1] << " ";
-        OBJ << faces[i][2] << "/" << faces[i][2] << "/" << faces[i][2] << "\n";
+        PC2_file.close();
+
+        delete normal_file;
     }
 
-    OBJ.close();
+    //return skeleton to bind pose so that other exporters can still be used
+    model_skeleton.set_bind_pose();
 }
 
-void ModelRipper::to_collada(std::string out_path, std::string name) {
+void ModelRipper::animations_as_stream(std::string dest, std::string name) {
 
-    //create dae file
-    std::ofstream DAE(out_path + name + ".dae", std::ios::trunc);
+    //posed vertex positions for each frame, and the frames in each clip
+    std::vector<std::vector<float>> frame_positions;
+    std::vector<int> clip_starts;
+    std::vector<int> clip_lengths;
 
-    //write header info
-    DAE << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
-           "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
-           "  <asset>\n"
-           "    <contributor>\n"
-           "      <author>DOTR Model Ripper</author>\n"
-           "    </contributor>\n"
-           "    <unit name=\"meter\" meter=\"1\"/>\n"
-           "    <up_axis>Y_UP</up_axis>\n"
-           "  </asset>\n";
-    
-    //write effects
-    DAE << "  <library_effects>\n";
+    get_frame_positions(frame_positions, clip_starts, clip_lengths);
 
-    for (int i = 0; i < texture_count; i++) {
+    FrameStream::write(dest + name + ".dfs", frame_positions, clip_starts, clip_lengths);
+}
 
-        //normal mesh effect
-        DAE << "    <effect id=\"tex_" << i << "-effect\">\n"
-               "      <profile_COMMON>\n"
-               "        <newparam sid=\"" << name << "_" << i << "_bmp-surface\">\n"
-               "          <surface type=\"2D\">\n"
-               "            <init_from>" << name << "_" << i << "_bmp</init_from>\n"
-               "          </surface>\n"
-               "        </newparam>\n"
-               "        <newparam sid=\"" << name << "_" << i << "_bmp-sampler\">\n"
-               "          <sampler2D>\n"
-               "            <source>" << name << "_" << i << "_bmp-surface</source>\n"
-               "          </sampler2D>\n"
-               "        </newparam>\n"
-               "        <technique sid=\"common\">\n"
-               "          <lambert>\n"
-               "            <diffuse>\n"
-               "              <texture texture=\"" << name << "_" << i << "_bmp-sampler\" texcoord=\"UVMap\"/>\n"
-               "            </diffuse>\n"
-               "          </lambert>\n"
-               "        </technique>\n"
-               "      </profile_COMMON>\n"
-               "    </effect>\n";
-        
-        //transparent mesh effect
-        DAE << "    <effect id=\"tex_t_" << i << "-effect\">\n"
-               "      <profile_COMMON>\n"
-               "        <newparam sid=\"" << name << "_" << i << "_bmp-surface\">\n"
-               "          <surface type=\"2D\">\n"
-               "            <init_from>" << name << "_" << i << "_bmp</init_from>\n"
-               "          </surface>\n"
-               "        </newparam>\n"
-               "        <newparam sid=\"" << name << "_" << i << "_bmp-sampler\">\n"
-               "          <sampler2D>\n"
-               "            <source>" << name << "_" << i << "_bmp-surface</source>\n"
-               "          </sampler2D>\n"
-               "        </newparam>\n"
-               "        <technique sid=\"common\">\n"
-               "          <lambert>\n"
-               "            <diffuse>\n"
-               "              <texture texture=\"" << name << "_" << i << "_bmp-sampler\" texcoord=\"UVMap\"/>\n"
-               "            </diffuse>\n"
-               "          </lambert>\n"
-               "        </technique>\n"
-               "      </profile_COMMON>\n"
-               "    </effect>\n";
-    }
+bool ModelRipper::verify_stream(std::string dest, std::string name) {
 
-    DAE << "  </library_effects>\n";
+    //path to stream file
+    std::string DFS_path = dest + name + ".dfs";
 
-    //write images
-    DAE << "  <library_images>\n";
+    FrameStreamReader reader;
 
-    for (int i = 0; i < texture_count; i++) {
+    if (!reader.open(DFS_path)) {
 
-        DAE << "    <image id=\"" << name << "_" << i << "_bmp\" name=\"" << name << "_" << i << "_bmp\">\n"
-               "      <init_from>" << name << "_" << i << ".bmp</init_from>\n"
-               "    </image>\n";
+        std::cout << "Error, could not read " << DFS_path << "\n";
+
+        return false;
     }
 
-    DAE << "  </library_images>\n";
+    //posed vertex positions for each frame, and the frames in each clip
+    std::vector<std::vector<float>> frame_positions;
+    std::vector<int> clip_starts;
+    std::vector<int> clip_lengths;
 
-    //write materials
-    DAE << "  <library_materials>\n";
+    get_frame_positions(frame_positions, clip_starts, clip_lengths);
 
-    for (int i = 0; i < texture_count; i++) {
+    if (reader.vertex_count() != vertices.size() || reader.frame_count() != frame_positions.size() || reader.clip_count() != clip_starts.size()) {
 
-        //normal mesh material
-        DAE << "    <material id=\"tex_" << i << "-material\" name=\"tex." << i << "\">\n"
-               "      <instance_effect url=\"#tex_" << i << "-effect\"/>\n"
-               "    </material>\n";
+        std::cout << "Error, " << DFS_path << " has the wrong number of vertices, frames, or clips\n";
 
-        //transparent mesh material
-        DAE << "    <material id=\"tex_t_" << i << "-material\" name=\"tex_t." << i << "\">\n"
-               "      <instance_effect url=\"#tex_t_" << i << "-effect\"/>\n"
-               "    </material>\n";
+        return false;
     }
 
-    DAE << "  </library_materials>\n";
+    for (int i = 0; i < clip_starts.size(); i++) {
 
-    //write geometry
-    DAE << "  <library_geometries>\n"
-           "    <geometry id=\"mon-mesh\" name=\"Mesh\">\n"
-           "      <mesh>\n"
-           "        <source id=\"mesh-positions\" name=\"position\">\n"
-           "          <float_array id=\"mesh-positions-array\" count=\"" << 3*vertices.size() << "\">";
-    
-    //write vertex positions
-    for (int i = 0; i < vertices.size(); i++) {
+        if (reader.clip_start(i) != clip_starts[i] || reader.clip_length(i) != clip_lengths[i]) {
 
-        DAE << vertices[i][0] << " " << vertices[i][1] << " " << vertices[i][2];
+            std::cout << "Error, clip " << i << " in " << DFS_path << " has the wrong frames\n";
 
-        if (i != vertices.size()-1) {
+            return false;
+        }
+    }
 
-            DAE << " ";
+    //positions are rounded to 16 bits within the bounding box of all frames, so they can be off by up to half a step along each axis
+    float minimum[3] = {INFINITY, INFINITY, INFINITY};
+    float maximum[3] = {-INFINITY, -INFINITY, -INFINITY};
+
+    for (int i = 0; i < frame_positions.size(); i++) {
+
+        for (int j = 0; j < frame_positions[i].size(); j++) {
+
+            minimum[j%3] = std::min(minimum[j%3], frame_positions[i][j]);
+            maximum[j%3] = std::max(maximum[j%3], frame_positions[i][j]);
         }
     }
 
-    DAE << "</float_array>\n"
-           "          <technique_common>\n"
-           "            <accessor source=\"#mesh-positions-array\" count=\"" << vertices.size() << "\" stride=\"3\">\n"
-           "              <param name=\"X\" type=\"float\"></param>\n"
-           "              <param name=\"Y\" type=\"float\"></param>\n"
-           "              <param name=\"Z\" type=\"float\"></param>\n"
-           "            </accessor>\n"
-           "          </technique_common>\n"
-           "        </source>\n"
-           "        <source id=\"mesh-normals\" name=\"normal\">\n"
-           "          <float_array id=\"mesh-normals-array\" count=\"" << 3*vertex_normals.size() << "\">";
+    //decoded positions of current frame
+    std::vector<float> positions;
 
-    //write vertex normals
-    for (int i = 0; i < vertex_normals.size(); i++) {
+    for (int i = frame_positions.size() - 1; i >= 0; i--) {
 
-        DAE << vertex_normals[i][0] << " " << vertex_normals[i][1] << " " << vertex_normals[i][2];
+        if (!reader.read_frame(i, positions)) {
 
-        if (i != vertex_normals.size()-1) {
+            std::cout << "Error, could not decode frame " << i << " of " << DFS_path << "\n";
 
-            DAE << " ";
+            return false;
+        }
+
+        for (int j = 0; j < positions.size(); j++) {
+
+            //allow a whole step, as the step is stored as a float
+            float tolerance = (maximum[j%3] - minimum[j%3])/65535 + 1e-6f*std::max(fabsf(minimum[j%3]), fabsf(maximum[j%3]));
+
+            if (fabsf(positions[j] - frame_positions[i][j]) > tolerance) {
+
+                std::cout << "Error, vertex " << j/3 << " of frame " << i << " in " << DFS_path << " is " << positions[j] << " instead of " << frame_positions[i][j] << "\n";
+
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void ModelRipper::animations_as_vat(std::string dest, std::string name, bool float_images) {
+
+    //frames of root joint, all joints share the same frames
+    std::vector<int> &frames = model_skeleton.root->animation_frames;
+
+    //file extension of textures
+    std::string extension = float_images ? ".pfm" : ".png";
+
+    //normals are always within -1 and 1
+    float normal_min[3] = {-1, -1, -1};
+    float normal_max[3] = {1, 1, 1};
+
+    //create json file describing textures
+    OutFile JSON_file(dest + name + " vat.json");
+
+    //text output for json file
+    TextBuffer JSON(JSON_file);
+
+    JSON << "{\n"
+            "  \"vertices\": " << vertices.size() << ",\n"
+            "  \"frames_per_second\": 30,\n"
+            "  \"format\": \"" << (float_images ? "pfm" : "png16") << "\",\n"
+            "  \"clips\": [";
+
+    //number of clips written
+    int n_clips = 0;
+
+    for (int i = 0; i < model_skeleton.clip_starts.size(); i++) {
+
+        //frames belonging to the current clip
+        std::vector<int> clip_frames;
+
+        for (int j = 0; j < frames.size(); j++) {
+
+            if (frames[j] >= model_skeleton.clip_starts[i] && frames[j] < model_skeleton.clip_starts[i] + model_skeleton.clip_lengths[i]) {
+
+                clip_frames.push_back(frames[j]);
+            }
+        }
+
+        if (clip_frames.size() == 0) continue;
+
+        //posed positions and normals, one row for each frame
+        std::vector<float> positions(3*vertices.size()*clip_frames.size());
+        std::vector<float> normals(3*vertices.size()*clip_frames.size());
+
+        for (int j = 0; j < clip_frames.size(); j++) {
+
+            pose_mesh(clip_frames[j]);
+
+            for (int k = 0; k < vertices.size(); k++) {
+
+                for (int l = 0; l < 3; l++) {
+
+                    positions[3*(j*vertices.size() + k) + l] = posed_vertices[k][l];
+                    normals[3*(j*vertices.size() + k) + l] = posed_normals[k][l];
+                }
+            }
+        }
+
+        //bounds of positions in clip
+        float position_min[3] = {0, 0, 0};
+        float position_max[3] = {0, 0, 0};
+
+        for (int j = 0; j < positions.size(); j++) {
+
+            if (j < 3 || positions[j] < position_min[j%3]) {
+
+                position_min[j%3] = positions[j];
+            }
+
+            if (j < 3 || positions[j] > position_max[j%3]) {
+
+                position_max[j%3] = positions[j];
+            }
+        }
+
+        //write textures
+        std::string position_file = name + " clip " + std::to_string(i) + " positions" + extension;
+        std::string normal_file = name + " clip " + std::to_string(i) + " normals" + extension;
+
+        write_vat_image(dest + position_file, vertices.size(), clip_frames.size(), positions, float_images, position_min, position_max);
+        write_vat_image(dest + normal_file, vertices.size(), clip_frames.size(), normals, float_images, normal_min, normal_max);
+
+        //describe clip in json file
+        if (n_clips > 0) {
+
+            JSON << ",";
+        }
+
+        JSON << "\n"
+                "    {\n"
+                "      \"name\": \"clip." << i << "\",\n"
+                "      \"frames\": " << clip_frames.size() << ",\n"
+                "      \"positions\": \"" << position_file << "\",\n"
+                "      \"normals\": \"" << normal_file << "\",\n"
+                "      \"position_min\": [";
+
+        for (int j = 0; j < 3; j++) {
+
+            if (j != 0) {
+
+                JSON << ", ";
+            }
+
+            JSON.write_exact(position_min[j]);
+        }
+
+        JSON << "],\n"
+                "      \"position_max\": [";
+
+        for (int j = 0; j < 3; j++) {
+
+            if (j != 0) {
+
+                JSON << ", ";
+            }
+
+            JSON.write_exact(position_max[j]);
+        }
+
+        JSON << "]\n"
+                "    }";
+
+        n_clips += 1;
+    }
+
+    JSON << "\n  ]\n}\n";
+
+    JSON_file.close();
+
+    //return skeleton to bind pose so that other exporters can still be used
+    model_skeleton.set_bind_pose();
+}
+
+void ModelRipper::write_textures(std::string dest, std::string name) {
+
+    //string for storing reused texture filename
+    std::string tex_filename;
+
+    //file with the same texture, if it has already been written
+    std::string existing_filename;
+
+    for (int i = 0; i < textures.size(); i++) {
+
+        tex_filename = dest + name + "_" + std::to_string(i) + "." + TexRipper::extension(texture_format);
+
+        TextureRegistry::Action action = texture_registry.claim(texture_hashes[i], tex_filename, existing_filename);
+
+        //texture file has already been written during this run
+        if (action == TextureRegistry::SKIP) continue;
+
+        //link to an identical texture written for an earlier model if possible
+        if (action == TextureRegistry::LINK && OutputTarget::get_default().link(existing_filename, tex_filename)) continue;
+
+        TexRipper::write(*textures[i], tex_filename, texture_format);
+    }
+}
+
+bool ModelRipper::build_atlas() {
+
+    //texture used by each vertex, starting at 0, or -1 if it is not used by any face
+    std::vector<int> vertex_textures(vertex_uvs.size(), -1);
+
+    for (int i = 0; i < faces.size(); i++) {
+
+        //faces without a valid texture cannot be placed in the atlas
+        if (face_textures[i] < 1 || face_textures[i] > textures.size() || textures[face_textures[i]-1]->width == 0 || textures[face_textures[i]-1]->height == 0) {
+
+            std::cout << "Could not build texture atlas, a face has no texture\n";
+
+            return false;
+        }
+
+        for (int j = 0; j < faces[i].size(); j++) {
+
+            int &vertex_texture = vertex_textures[faces[i][j]-1];
+
+            //a shared vertex would need a different uv for each texture
+            if (vertex_texture != -1 && vertex_texture != face_textures[i]-1) {
+
+                std::cout << "Could not build texture atlas, a vertex is used by faces with different textures\n";
+
+                return false;
+            }
+
+            vertex_texture = face_textures[i]-1;
+        }
+    }
+
+    //range of uvs used by each texture
+    std::vector<double> min_u(textures.size(), INFINITY);
+    std::vector<double> min_v(textures.size(), INFINITY);
+    std::vector<double> max_u(textures.size(), -INFINITY);
+    std::vector<double> max_v(textures.size(), -INFINITY);
+
+    for (int i = 0; i < vertex_uvs.size(); i++) {
+
+        if (vertex_textures[i] == -1) continue;
+
+        min_u[vertex_textures[i]] = std::min(min_u[vertex_textures[i]], vertex_uvs[i][0]);
+        min_v[vertex_textures[i]] = std::min(min_v[vertex_textures[i]], vertex_uvs[i][1]);
+        max_u[vertex_textures[i]] = std::max(max_u[vertex_textures[i]], vertex_uvs[i][0]);
+        max_v[vertex_textures[i]] = std::max(max_v[vertex_textures[i]], vertex_uvs[i][1]);
+    }
+
+    //one tile for each texture used by a face
+    std::vector<atlas_tile> tiles;
+
+    //tile of each texture, or -1 if the texture is unused
+    std::vector<int> texture_tiles(textures.size(), -1);
+
+    //total area of tiles and width of the widest tile, in pixels
+    long long area = 0;
+    int widest = 0;
+
+    for (int i = 0; i < textures.size(); i++) {
+
+        if (min_u[i] > max_u[i]) continue;
+
+        atlas_tile tile;
+
+        tile.texture = i;
+        tile.first_u = floor(min_u[i]);
+        tile.first_v = floor(min_v[i]);
+        tile.repeats_u = std::max(1, static_cast<int>(ceil(max_u[i])) - tile.first_u);
+        tile.repeats_v = std::max(1, static_cast<int>(ceil(max_v[i])) - tile.first_v);
+
+        if (tile.repeats_u > ATLAS_MAX_REPEATS || tile.repeats_v > ATLAS_MAX_REPEATS) {
+
+            std::cout << "Could not build texture atlas, texture " << i << " is repeated too many times\n";
+
+            return false;
+        }
+
+        tile.width = tile.repeats_u*textures[i]->width + 2*ATLAS_PADDING;
+        tile.height = tile.repeats_v*textures[i]->height + 2*ATLAS_PADDING;
+
+        area += static_cast<long long>(tile.width)*tile.height;
+        widest = std::max(widest, tile.width);
+
+        texture_tiles[i] = tiles.size();
+        tiles.push_back(tile);
+    }
+
+    //nothing to combine
+    if (tiles.empty()) return true;
+
+    //tiles are placed in rows from tallest to shortest, so that little space is left above shorter tiles
+    std::vector<int> order(tiles.size());
+
+    for (int i = 0; i < order.size(); i++) {
+
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&tiles](int a, int b) {
+
+        return tiles[a].height > tiles[b].height;
+    });
+
+    //atlas width is the smallest power of 2 which fits the widest tile and gives a roughly square atlas
+    int atlas_width = 1;
+
+    while (atlas_width < widest || static_cast<long long>(atlas_width)*atlas_width < area) {
+
+        atlas_width *= 2;
+    }
+
+    int atlas_height;
+
+    while (true) {
+
+        //position of the next tile, and the height of the current row
+        int x = 0;
+        int y = 0;
+        int row_height = 0;
+
+        for (int i = 0; i < order.size(); i++) {
+
+            atlas_tile &tile = tiles[order[i]];
+
+            //start a new row once the current one is full
+            if (x + tile.width > atlas_width) {
+
+                x = 0;
+                y += row_height;
+                row_height = 0;
+            }
+
+            tile.x = x;
+            tile.y = y;
+
+            x += tile.width;
+            row_height = std::max(row_height, tile.height);
+        }
+
+        //height is a multiple of 4 so that the atlas can be block compressed
+        atlas_height = (y + row_height + 3)/4*4;
+
+        //widen the atlas if the rows are much taller than it is wide
+        if (atlas_height <= atlas_width || atlas_width >= ATLAS_MAX_SIZE) break;
+
+        atlas_width *= 2;
+    }
+
+    if (atlas_width > ATLAS_MAX_SIZE || atlas_height > ATLAS_MAX_SIZE) {
+
+        std::cout << "Could not build texture atlas, textures do not fit in " << ATLAS_MAX_SIZE << "x" << ATLAS_MAX_SIZE << " pixels\n";
+
+        return false;
+    }
+
+    //copy each texture into its tile, repeated and mirrored as it would be when sampled, with a border continuing the mirroring
+    TexImage atlas;
+
+    atlas.width = atlas_width;
+    atlas.height = atlas_height;
+    atlas.pixels.assign(static_cast<size_t>(atlas_width)*atlas_height, 0);
+
+    for (int i = 0; i < tiles.size(); i++) {
+
+        const atlas_tile &tile = tiles[i];
+        const TexImage &texture = *textures[tile.texture];
+
+        for (int y = 0; y < tile.height; y++) {
+
+            //row of texture, both stored from the bottom row up
+            const unsigned int *source = texture.pixels.data() + static_cast<size_t>(mirror_coordinate(y - ATLAS_PADDING + tile.first_v*texture.height, texture.height))*texture.width;
+            unsigned int *destination = atlas.pixels.data() + static_cast<size_t>(tile.y + y)*atlas_width + tile.x;
+
+            for (int x = 0; x < tile.width; x++) {
+
+                destination[x] = source[mirror_coordinate(x - ATLAS_PADDING + tile.first_u*texture.width, texture.width)];
+            }
+        }
+    }
+
+    //move uvs into the tile of their texture
+    for (int i = 0; i < vertex_uvs.size(); i++) {
+
+        if (vertex_textures[i] == -1) continue;
+
+        const atlas_tile &tile = tiles[texture_tiles[vertex_textures[i]]];
+        const TexImage &texture = *textures[tile.texture];
+
+        vertex_uvs[i][0] = (tile.x + ATLAS_PADDING + (vertex_uvs[i][0] - tile.first_u)*texture.width)/atlas_width;
+        vertex_uvs[i][1] = (tile.y + ATLAS_PADDING + (vertex_uvs[i][1] - tile.first_v)*texture.height)/atlas_height;
+    }
+
+    //order faces so that opaque and transparent faces each form a single material
+    std::vector<int> face_order(faces.size());
+
+    for (int i = 0; i < face_order.size(); i++) {
+
+        face_order[i] = i;
+    }
+
+    std::stable_partition(face_order.begin(), face_order.end(), [](int face) {
+
+        return !face_transparency[face];
+    });
+
+    std::vector<std::vector<int>> ordered_faces(faces.size());
+    std::vector<bool> ordered_transparency(faces.size());
+
+    for (int i = 0; i < face_order.size(); i++) {
+
+        ordered_faces[i].swap(faces[face_order[i]]);
+        ordered_transparency[i] = face_transparency[face_order[i]];
+    }
+
+    faces.swap(ordered_faces);
+    face_transparency.swap(ordered_transparency);
+    face_textures.assign(faces.size(), 1);
+
+    //atlas has no palette, as its textures do not share one
+    texture_hashes.assign(1, Hash::hash64(reinterpret_cast<const char *>(atlas.pixels.data()), atlas.pixels.size()*sizeof(unsigned int)));
+    textures.assign(1, std::make_shared<const TexImage>(std::move(atlas)));
+    texture_count = 1;
+
+    return true;
+}
+
+void ModelRipper::generate_mtl(std::string dest, std::string name) {
+
+    //create mtl file
+    OutFile MTL_file(dest + name + ".mtl");
+
+    //text output for mtl file
+    TextBuffer MTL(MTL_file);
+
+    //extension of texture files
+    std::string tex_ext = TexRipper::extension(texture_format);
+
+    //count number of textures used
+    int n_tex = 0;
+
+    for (int i = 0; i < faces.size(); i++) {
+
+        if (face_textures[i] > n_tex) {
+
+            n_tex = face_textures[i];
+        }
+    }
+
+    //write materials
+    for (int i = 0; i < n_tex; i++) {
+
+        //ordinary material
+        //requires alpha clipping for transparency < 0.5
+        MTL << "newmtl tex." << i+1 << "\n";
+        MTL << "Ns 0.000000\n"
+        "Ka 1.000000 1.000000 1.000000\n"
+        "Ks 1.000000 1.000000 1.000000\n"
+        "Ke 0.000000 0.000000 0.000000\n"
+        "Ni 1.500000\n"
+        "illum 2\n";
+        MTL << "map_Kd " << name << "_" << i << "." << tex_ext << "\n";
+        MTL << "map_d " << name << "_" << i << "." << tex_ext << "\n";
+        MTL << "\n";
+
+        //transparent material
+        MTL << "newmtl tex_t." << i+1 << "\n";
+        MTL << "Ns 0.000000\n"
+        "Ka 1.000000 1.000000 1.000000\n"
+        "Ks 1.000000 1.000000 1.000000\n"
+        "Ke 0.000000 0.000000 0.000000\n"
+        "Ni 1.500000\n"
+        "illum 2\n";
+        MTL << "map_Kd " << name << "_" << i << "." << tex_ext << "\n";
+        MTL << "map_d " << name << "_" << i << "." << tex_ext << "\n"; 
+        MTL << "\n";
+    }
+
+    //close file
+    MTL_file.close();
+}
+
+void ModelRipper::to_obj(std::string dest, std::string name, int frame) {
+
+    //path to obj file
+    std::string obj_path;
+
+    //vertices and normals to write, posed vertices are used when writing a frame of animation
+    std::vector<std::vector<double>> &out_vertices = (frame >= 0) ? posed_vertices : vertices;
+    std::vector<std::vector<double>> &out_normals = (frame >= 0) ? posed_normals : vertex_normals;
+
+    //create obj file
+    if (frame >= 0) {
+
+        obj_path = dest + name + " frame " + std::to_string(frame) + ".obj";
+
+    } else {
+
+        obj_path = dest + name + ".obj";
+    }
+
+    OutFile OBJ_file(obj_path);
+
+    //text output for obj file
+    TextBuffer OBJ(OBJ_file);
+
+    //declare mtl library
+    OBJ << "mtllib " + name << ".mtl\n";
+
+    //write vertices
+    for (int i = 0; i < out_vertices.size(); i++) {
+
+        OBJ << "v " << out_vertices[i][0] << " " << out_vertices[i][1] << " " << out_vertices[i][2] << "\n";
+    }
+
+    //write uvs
+    for (int i = 0; i < vertex_uvs.size(); i++) {
+
+        OBJ << "vt " << vertex_uvs[i][0] << " " << vertex_uvs[i][1] << "\n";
+    }
+
+    //write vertex normals
+    for (int i = 0; i < out_normals.size(); i++) {
+
+        OBJ << "vn " << out_normals[i][0] << " " << out_normals[i][1] << " " << out_normals[i][2] << "\n";
+    }
+    
+    //write faces
+    for (int i = 0; i < faces.size(); i++) {
+
+        //change texture
+        if (i == 0) {
+
+            if (face_transparency[i]) {
+
+                OBJ << "usemtl tex_t." << face_textures[i] << "\n";
+            
+            } else {
+                
+                OBJ << "usemtl tex." << face_textures[i] << "\n";
+            }
+        
+        } else if (face_textures[i] != face_textures[i-1] || face_transparency[i] != face_transparency[i-1]) {
+
+            if (face_transparency[i]) {
+
+                OBJ << "usemtl tex_t." << face_textures[i] << "\n";
+            
+            } else {
+                
+                OBJ << "usemtl tex." << face_textures[i] << "\n";
+            }
+        }
+
+        OBJ << "f ";
+        OBJ << faces[i][0] << "/" << faces[i][0] << "/" << faces[i][0] << " ";
+        OBJ << faces[i][1] << "/" << faces[i][1] << "/" << faces[i][1] << " ";
+        OBJ << faces[i][2] << "/" << faces[i][2] << "/" << faces[i][2] << "\n";
+    }
+
+    OBJ_file.close();
+}
+
+void ModelRipper::to_obj_vertices(std::string dest, std::string name, int frame, bool write_normals) {
+
+    //create obj file
+    OutFile OBJ_file(dest + name + " frame " + std::to_string(frame) + ".obj");
+
+    //text output for obj file
+    TextBuffer OBJ(OBJ_file);
+
+    //write vertices
+    for (int i = 0; i < posed_vertices.size(); i++) {
+
+        OBJ << "v " << posed_vertices[i][0] << " " << posed_vertices[i][1] << " " << posed_vertices[i][2] << "\n";
+    }
+
+    //write vertex normals
+    if (write_normals) {
+
+        for (int i = 0; i < posed_normals.size(); i++) {
+
+            OBJ << "vn " << posed_normals[i][0] << " " << posed_normals[i][1] << " " << posed_normals[i][2] << "\n";
+        }
+    }
+
+    OBJ_file.close();
+}
+
+void ModelRipper::to_collada(std::string out_path, std::string name) {
+
+    //create dae file
+    OutFile DAE_file(out_path + name + ".dae");
+
+    //text output for dae file
+    TextBuffer DAE(DAE_file);
+
+    //extension of texture files, also used in texture ids
+    std::string tex_ext = TexRipper::extension(texture_format);
+
+    //write header info
+    DAE << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+           "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n"
+           "  <asset>\n"
+           "    <contributor>\n"
+           "      <author>DOTR Model Ripper</author>\n"
+           "    </contributor>\n"
+           "    <unit name=\"meter\" meter=\"1\"/>\n"
+           "    <up_axis>Y_UP</up_axis>\n"
+           "  </asset>\n";
+    
+    //write effects
+    DAE << "  <library_effects>\n";
+
+    for (int i = 0; i < texture_count; i++) {
+
+        //normal mesh effect
+        DAE << "    <effect id=\"tex_" << i << "-effect\">\n"
+               "      <profile_COMMON>\n"
+               "        <newparam sid=\"" << name << "_" << i << "_" << tex_ext << "-surface\">\n"
+               "          <surface type=\"2D\">\n"
+               "            <init_from>" << name << "_" << i << "_" << tex_ext << "</init_from>\n"
+               "          </surface>\n"
+               "        </newparam>\n"
+               "        <newparam sid=\"" << name << "_" << i << "_" << tex_ext << "-sampler\">\n"
+               "          <sampler2D>\n"
+               "            <source>" << name << "_" << i << "_" << tex_ext << "-surface</source>\n"
+               "          </sampler2D>\n"
+               "        </newparam>\n"
+               "        <technique sid=\"common\">\n"
+               "          <lambert>\n"
+               "            <diffuse>\n"
+               "              <texture texture=\"" << name << "_" << i << "_" << tex_ext << "-sampler\" texcoord=\"UVMap\"/>\n"
+               "            </diffuse>\n"
+               "          </lambert>\n"
+               "        </technique>\n"
+               "      </profile_COMMON>\n"
+               "    </effect>\n";
+        
+        //transparent mesh effect
+        DAE << "    <effect id=\"tex_t_" << i << "-effect\">\n"
+               "      <profile_COMMON>\n"
+               "        <newparam sid=\"" << name << "_" << i << "_" << tex_ext << "-surface\">\n"
+               "          <surface type=\"2D\">\n"
+               "            <init_from>" << name << "_" << i << "_" << tex_ext << "</init_from>\n"
+               "          </surface>\n"
+               "        </newparam>\n"
+               "        <newparam sid=\"" << name << "_" << i << "_" << tex_ext << "-sampler\">\n"
+               "          <sampler2D>\n"
+               "            <source>" << name << "_" << i << "_" << tex_ext << "-surface</source>\n"
+               "          </sampler2D>\n"
+               "        </newparam>\n"
+               "        <technique sid=\"common\">\n"
+               "          <lambert>\n"
+               "            <diffuse>\n"
+               "              <texture texture=\"" << name << "_" << i << "_" << tex_ext << "-sampler\" texcoord=\"UVMap\"/>\n"
+               "            </diffuse>\n"
+               "          </lambert>\n"
+               "        </technique>\n"
+               "      </profile_COMMON>\n"
+               "    </effect>\n";
+    }
+
+    DAE << "  </library_effects>\n";
+
+    //write images
+    DAE << "  <library_images>\n";
+
+    for (int i = 0; i < texture_count; i++) {
+
+        DAE << "    <image id=\"" << name << "_" << i << "_" << tex_ext << "\" name=\"" << name << "_" << i << "_" << tex_ext << "\">\n"
+               "      <init_from>" << name << "_" << i << "." << tex_ext << "</init_from>\n"
+               "    </image>\n";
+    }
+
+    DAE << "  </library_images>\n";
+
+    //write materials
+    DAE << "  <library_materials>\n";
+
+    for (int i = 0; i < texture_count; i++) {
+
+        //normal mesh material
+        DAE << "    <material id=\"tex_" << i << "-material\" name=\"tex." << i << "\">\n"
+               "      <instance_effect url=\"#tex_" << i << "-effect\"/>\n"
+               "    </material>\n";
+
+        //transparent mesh material
+        DAE << "    <material id=\"tex_t_" << i << "-material\" name=\"tex_t." << i << "\">\n"
+               "      <instance_effect url=\"#tex_t_" << i << "-effect\"/>\n"
+               "    </material>\n";
+    }
+
+    DAE << "  </library_materials>\n";
+
+    //write geometry
+    DAE << "  <library_geometries>\n"
+           "    <geometry id=\"mon-mesh\" name=\"Mesh\">\n"
+           "      <mesh>\n"
+           "        <source id=\"mesh-positions\" name=\"position\">\n"
+           "          <float_array id=\"mesh-positions-array\" count=\"" << 3*vertices.size() << "\">";
+    
+    //write vertex positions
+    for (int i = 0; i < vertices.size(); i++) {
+
+        DAE << vertices[i][0] << " " << vertices[i][1] << " " << vertices[i][2];
+
+        if (i != vertices.size()-1) {
+
+            DAE << " ";
+        }
+    }
+
+    DAE << "</float_array>\n"
+           "          <technique_common>\n"
+           "            <accessor source=\"#mesh-positions-array\" count=\"" << vertices.size() << "\" stride=\"3\">\n"
+           "              <param name=\"X\" type=\"float\"></param>\n"
+           "              <param name=\"Y\" type=\"float\"></param>\n"
+           "              <param name=\"Z\" type=\"float\"></param>\n"
+           "            </accessor>\n"
+           "          </technique_common>\n"
+           "        </source>\n"
+           "        <source id=\"mesh-normals\" name=\"normal\">\n"
+           "          <float_array id=\"mesh-normals-array\" count=\"" << 3*vertex_normals.size() << "\">";
+
+    //write vertex normals
+    for (int i = 0; i < vertex_normals.size(); i++) {
+
+        DAE << vertex_normals[i][0] << " " << vertex_normals[i][1] << " " << vertex_normals[i][2];
+
+        if (i != vertex_normals.size()-1) {
+
+            DAE << " ";
+        }
+    }
+
+    DAE << "</float_array>\n"
+           "          <technique_common>\n"
+           "            <accessor source=\"#mesh-normals-array\" count=\"" << vertex_normals.size() << "\" stride=\"3\">\n"
+           "              <param name=\"X\" type=\"float\"></param>\n"
+           "              <param name=\"Y\" type=\"float\"></param>\n"
+           "              <param name=\"Z\" type=\"float\"></param>\n"
+           "            </accessor>\n"
+           "          </technique_common>\n"
+           "        </source>\n"
+           "        <source id=\"mesh-map\" name=\"map\">\n"
+           "          <float_array id=\"mesh-map-array\" count=\"" << 2*vertex_uvs.size() << "\">";
+
+    //write vertex uvs
+    for (int i = 0; i < vertex_uvs.size(); i++) {
+
+        DAE << vertex_uvs[i][0] << " " << vertex_uvs[i][1];
+
+        if (i != vertex_uvs.size()-1) {
+
+            DAE << " ";
+        }
+    }
+
+    //need to break up into different materials
+    DAE << "</float_array>\n"
+           "          <technique_common>\n"
+           "            <accessor source=\"#mesh-map-array\" count=\"" << vertex_uvs.size() << "\" stride=\"2\">\n"
+           "              <param name=\"S\" type=\"float\"></param>\n"
+           "              <param name=\"T\" type=\"float\"></param>\n"
+           "            </accessor>\n"
+           "          </technique_common>\n"
+           "        </source>\n"
+           "        <vertices id=\"mesh-vertices\">\n"
+           "          <input semantic=\"POSITION\" source=\"#mesh-positions\"></input>\n"
+           "        </vertices>\n";
+    
+    //previous index at which we stopped adding faces to mesh
+    int prev_index = 0;
+
+    //produce triangles tags for each section of the mesh with a different material
+    for (int i = 1; i <= faces.size(); i++) {
+
+        if ((face_textures[i] != face_textures[i-1]) || (face_transparency[i] != face_transparency[i-1]) || (i == faces.size())) {
+
+            DAE << "        <triangles material=\"tex_";
+            
+            if (face_transparency[i-1]) {
+
+                DAE << "t_";
+            }
+
+            DAE << face_textures[i-1]-1 << "-material\" count=\"" << i - prev_index << "\">\n"
+                   "          <input semantic=\"VERTEX\" source=\"#mesh-vertices\" offset=\"0\"></input>\n"
+                   "          <input semantic=\"NORMAL\" source=\"#mesh-normals\" offset=\"1\"></input>\n"
+                   "          <input semantic=\"TEXCOORD\" source=\"#mesh-map\" offset=\"2\"></input>\n"
+                   "          <p>";
+
+            for (int j = prev_index; j < i; j++) {
+
+                DAE << faces[j][0]-1 << " " << faces[j][0]-1 << " " << faces[j][0]-1 << " ";
+                DAE << faces[j][1]-1 << " " << faces[j][1]-1 << " " << faces[j][1]-1 << " ";
+                DAE << faces[j][2]-1 << " " << faces[j][2]-1 << " " << faces[j][2]-1;
+
+                if (j != i-1) {
+
+                    DAE << " ";
+                }
+            }
+
+            prev_index = i;
+
+            DAE << "</p>\n"
+                   "        </triangles>\n";
+        }
+    }
+    
+    DAE << "      </mesh>\n"
+           "    </geometry>\n"
+           "  </library_geometries>\n";
+
+    //store number of joints
+    int n_joints = model_skeleton.count_joints();
+
+    //skin mesh
+    DAE << "  <library_controllers>\n"
+           "    <controller id=\"mesh-skin\" name=\"skin\">\n"
+           "      <skin source=\"#mon-mesh\">\n"
+           "        <bind_shape_matrix>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</bind_shape_matrix>\n"
+           "        <source id=\"mesh-skin-joints\">\n"
+           "          <Name_array id=\"mesh-skin-joints-array\" count=\"" << n_joints << "\">";
+    
+    for (int i = 0; i < n_joints; i++) {
+
+        DAE << "joint_" << i;
+
+        if (i != n_joints-1) {
+
+            DAE << " ";
+        }
+    }
+
+    DAE << "</Name_array>\n"
+           "          <technique_common>\n"
+           "            <accessor source=\"#mesh-skin-joints-array\" count=\"" << n_joints << "\" stride=\"1\">\n"
+           "              <param name=\"JOINT\" type=\"Name\"></param>\n"
+           "            </accessor>\n"
+           "          </technique_common>\n"
+           "        </source>\n"
+           "        <source id=\"mesh-skin-bind_poses\">\n"
+           "          <float_array id=\"mesh-skin-bind_poses-array\" count=\"" << 16*n_joints << "\">";
+    
+    model_skeleton.pose_array_collada(DAE);
+
+    DAE << "</float_array>\n"
+           "          <technique_common>\n"
+           "            <accessor source=\"#mesh-skin-bind_poses-array\" count=\"" << n_joints << "\" stride=\"16\">\n"
+           "              <param name=\"TRANSFORM\" type=\"float4x4\"></param>\n"
+           "            </accessor>\n"
+           "          </technique_common>\n"
+           "        </source>\n";
+    
+
+    //count number of vertex weights
+    int n_weights = 0;
+
+    for (int i = 0; i < vertex_weights.size(); i++) {
+
+        n_weights += vertex_weights[i].size();
+    }
+
+    DAE << "        <source id=\"mesh-skin-weights\">\n"
+           "          <float_array id=\"mesh-skin-weights-array\" count=\"" << n_weights << "\">";
+    
+    for (int i = 0; i < vertex_weights.size(); i++) {
+
+        for (int j = 0; j < vertex_weights[i].size(); j++) {
+
+            DAE << vertex_weights[i][j];
+
+            if (j != vertex_weights[i].size()-1) {
+
+                DAE << " ";
+            }
+        }
+
+        if (i != vertex_weights.size()-1) {
+
+            DAE << " ";
         }
     }
 
     DAE << "</float_array>\n"
            "          <technique_common>\n"
-           "            <accessor source=\"#mesh-normals-array\" count=\"" << vertex_normals.size() << "\" stride=\"3\">\n"
-           "              <param name=\"X\" type=\"float\"></param>\n"
-           "              <param name=\"Y\" type=\"float\"></param>\n"
-           "              <param name=\"Z\" type=\"float\"></param>\n"
+           "            <accessor source=\"#mesh-skin-weights-array\" count=\"" << n_weights << "\" stride=\"1\">\n"
+           "              <param name=\"WEIGHT\" type=\"float\"></param>\n"
            "            </accessor>\n"
            "          </technique_common>\n"
            "        </source>\n"
-           "        <source id=\"mesh-map\" name=\"map\">\n"
-           "          <float_array id=\"mesh-map-array\" count=\"" << 2*vertex_uvs.size() << "\">";
+           "        <joints>\n"
+           "          <input semantic=\"JOINT\" source=\"#mesh-skin-joints\"></input>\n"
+           "          <input semantic=\"INV_BIND_MATRIX\" source=\"#mesh-skin-bind_poses\"></input>\n"
+           "        </joints>\n"
+           "        <vertex_weights count=\"" << vertex_weights.size() << "\">\n"
+           "          <input semantic=\"JOINT\" source=\"#mesh-skin-joints\" offset=\"0\"></input>\n"
+           "          <input semantic=\"WEIGHT\" source=\"#mesh-skin-weights\" offset=\"1\"></input>\n"
+           "          <vcount>";
+
+    //write number of weights for each vertex
+    for (int i = 0; i < vertex_weights.size(); i++) {
+
+        DAE << vertex_weights[i].size();
+
+        if (i != vertex_weights.size()-1) {
+
+            DAE << " ";
+        }
+    }
+
+    DAE << "</vcount>\n"
+           "          <v>";
+
+    //tracks current index
+    int counter = 0;
+
+    //write each joint index and associated weight index for each vertex
+    for (int i = 0; i < vertex_weights.size(); i++) {
+
+        for (int j = 0; j < vertex_weights[i].size(); j++) {
+
+            DAE << vertex_bones[i][j] << " " << counter;
+
+            if (j != vertex_weights[i].size()-1) {
+
+                DAE << " ";
+            }
+
+            counter += 1;
+        }
+
+        if (i != vertex_weights.size()-1) {
+
+            DAE << " ";
+        }
+    }
+
+
+    DAE << "</v>\n"
+           "        </vertex_weights>\n"
+           "      </skin>\n"
+           "    </controller>\n"
+           "  </library_controllers>\n";
+
+    //write skeleton
+    DAE << "  <library_visual_scenes>\n"
+           "    <visual_scene id=\"Scene\" name=\"Scene\">\n"
+           "      <node id=\"Armature\" name=\"Armature\" type=\"NODE\">\n"
+           "        <matrix sid=\"transform\">1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</matrix>\n";
+    
+    model_skeleton.collada(DAE, 4);
+
+    DAE << "      </node>\n";
+
+    //write controller node
+    DAE << "      <node id=\"mesh\" name=\"Mesh\">\n"
+           "        <instance_controller url=\"#mesh-skin\">\n"
+           "          <skeleton>#Armature</skeleton>"
+           "          <bind_material>\n"
+           "            <technique_common>\n";
+
+    for (int i = 0; i < texture_count; i++) {
+
+        //normal mesh material
+        DAE << "              <instance_material symbol=\"tex_" << i << "-material\" target=\"#tex_" << i << "-material\">\n"
+               "                <bind_vertex_input semantic=\"UVMap\" input_semantic=\"TEXCOORD\" input_set=\"0\"/>\n"
+               "              </instance_material>\n";
+        
+        //transparent mesh material
+        DAE << "              <instance_material symbol=\"tex_t_" << i << "-material\" target=\"#tex_t_" << i << "-material\">\n"
+               "                <bind_vertex_input semantic=\"UVMap\" input_semantic=\"TEXCOORD\" input_set=\"0\"/>\n"
+               "              </instance_material>\n";
+    }
+
+    DAE << "            </technique_common>\n"
+           "          </bind_material>\n"
+           "        </instance_controller>\n"
+           "      </node>\n"
+           "    </visual_scene>\n"
+           "  </library_visual_scenes>\n"
+           "  <library_animations>\n";
+
+    model_skeleton.animation_collada(DAE);
+
+    DAE << "  </library_animations>\n"
+           "  <scene>\n"
+           "    <instance_visual_scene url=\"#Scene\"/>\n"
+           "  </scene>\n"
+           "</COLLADA>";
+
+    DAE_file.close();
+}
+
+void ModelRipper::to_dmf(std::string dest, std::string name) {
+
+    //sections are written by ModelFileWriter, which pads each one to keep arrays aligned
+    ModelFileWriter DMF;
+
+    //store number of joints
+    int n_joints = model_skeleton.count_joints();
+
+    //write bind pose vertices, normals, and uvs
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+
+    for (int i = 0; i < vertices.size(); i++) {
+
+        for (int j = 0; j < 3; j++) {
+
+            positions.push_back(vertices[i][j]);
+            normals.push_back(vertex_normals[i][j]);
+        }
+
+        uvs.push_back(vertex_uvs[i][0]);
+        uvs.push_back(vertex_uvs[i][1]);
+    }
+
+    DMF.add("VPOS", positions, vertices.size());
+    DMF.add("VNRM", normals, vertices.size());
+    DMF.add("VUV ", uvs, vertices.size());
+
+    //write faces, with indices and textures starting at 0
+    std::vector<unsigned int> indices;
+    std::vector<ModelFileFace> face_materials(faces.size());
+
+    for (int i = 0; i < faces.size(); i++) {
+
+        for (int j = 0; j < 3; j++) {
+
+            indices.push_back(faces[i][j] - 1);
+        }
+
+        face_materials[i].texture = face_textures[i] - 1;
+        face_materials[i].flags = face_transparency[i] ? 1 : 0;
+    }
+
+    DMF.add("FIDX", indices, faces.size());
+    DMF.add("FMAT", face_materials, faces.size());
+
+    //write influences of each vertex, with positions and normals relative to each joint
+    std::vector<unsigned int> influence_starts;
+    std::vector<ModelFileInfluence> influences;
+
+    for (int i = 0; i < vertices.size(); i++) {
+
+        influence_starts.push_back(influences.size());
+
+        for (int j = 0; j < vertex_joints[i].size(); j++) {
+
+            ModelFileInfluence influence;
+
+            influence.joint = vertex_joints[i][j]->order;
+            influence.weight = vertex_weights[i][j];
+
+            for (int k = 0; k < 3; k++) {
+
+                influence.position[k] = vertex_local_positions[i][3*j + k];
+                influence.normal[k] = vertex_local_normals[i][3*j + k];
+            }
+
+            influences.push_back(influence);
+        }
+    }
+
+    influence_starts.push_back(influences.size());
+
+    DMF.add("SKNO", influence_starts, vertices.size() + 1);
+    DMF.add("SKIN", influences, influences.size());
+
+    //write joints in bind pose
+    std::vector<ModelFileJoint> joints(n_joints);
+
+    for (int i = 0; i < n_joints; i++) {
+
+        Joint *joint = model_skeleton.find_by_order(i);
+
+        //matrices are stored transposed, so element [c][r] is row r and column c
+        for (int j = 0; j < 16; j++) {
+
+            joints[i].local[j] = joint->joint_space[j%4][j/4];
+            joints[i].world[j] = joint->world_space[j%4][j/4];
+        }
+
+        joints[i].parent = (joint->parent != nullptr) ? joint->parent->order : -1;
+        joints[i].id = joint->joint_id;
+        joints[i].reserved[0] = 0;
+        joints[i].reserved[1] = 0;
+    }
+
+    DMF.add("JNTS", joints, n_joints);
+
+    //frames of root joint, all joints share the same frames
+    std::vector<int> &frames = model_skeleton.root->animation_frames;
+
+    //write world matrix of each joint for every frame, which is what pose_mesh uses
+    std::vector<unsigned int> frame_numbers(frames.begin(), frames.end());
+    std::vector<float> poses;
+
+    for (int i = 0; i < frames.size(); i++) {
+
+        model_skeleton.set_frame(frames[i]);
+
+        for (int j = 0; j < n_joints; j++) {
+
+            Joint *joint = model_skeleton.find_by_order(j);
+
+            for (int k = 0; k < 16; k++) {
+
+                poses.push_back(joint->world_space[k%4][k/4]);
+            }
+        }
+    }
+
+    model_skeleton.set_bind_pose();
+
+    DMF.add("FRMS", frame_numbers, frames.size());
+    DMF.add("POSE", poses, frames.size()*n_joints);
+
+    //write range of frames in each clip
+    std::vector<ModelFileClip> clips(model_skeleton.clip_starts.size());
+
+    for (int i = 0; i < clips.size(); i++) {
+
+        clips[i].first = 0;
+        clips[i].count = 0;
+
+        for (int j = 0; j < frames.size(); j++) {
+
+            if (frames[j] < model_skeleton.clip_starts[i]) {
+
+                clips[i].first = j + 1;
+
+            } else if (frames[j] < model_skeleton.clip_starts[i] + model_skeleton.clip_lengths[i]) {
+
+                clips[i].count += 1;
+            }
+        }
+    }
+
+    DMF.add("CLIP", clips, clips.size());
+
+    //write textures
+    std::vector<ModelFileTexture> texture_info(textures.size());
+    std::vector<unsigned int> pixels;
+
+    for (int i = 0; i < textures.size(); i++) {
+
+        texture_info[i].width = textures[i]->width;
+        texture_info[i].height = textures[i]->height;
+        texture_info[i].first_pixel = pixels.size();
+        texture_info[i].reserved = 0;
+
+        pixels.insert(pixels.end(), textures[i]->pixels.begin(), textures[i]->pixels.end());
+    }
+
+    DMF.add("TEXI", texture_info, textures.size());
+    DMF.add("TEXP", pixels, pixels.size());
+
+    DMF.write(dest + name + ".dmf");
+}
+
+bool ModelRipper::verify_dmf(std::string dest, std::string name) {
+
+    //path to container file
+    std::string DMF_path = dest + name + ".dmf";
+
+    ModelFileReader reader;
+
+    if (!reader.open(DMF_path)) {
+
+        std::cout << "Error, could not read " << DMF_path << "\n";
+
+        return false;
+    }
+
+    ModelFileArray<float> uvs = reader.section<float>("VUV ");
+    ModelFileArray<unsigned int> indices = reader.section<unsigned int>("FIDX");
+    ModelFileArray<ModelFileFace> face_materials = reader.section<ModelFileFace>("FMAT");
+    ModelFileArray<unsigned int> influence_starts = reader.section<unsigned int>("SKNO");
+    ModelFileArray<ModelFileInfluence> influences = reader.section<ModelFileInfluence>("SKIN");
+    ModelFileArray<unsigned int> frame_numbers = reader.section<unsigned int>("FRMS");
+    ModelFileArray<float> poses = reader.section<float>("POSE");
+    ModelFileArray<ModelFileTexture> texture_info = reader.section<ModelFileTexture>("TEXI");
+    ModelFileArray<unsigned int> pixels = reader.section<unsigned int>("TEXP");
+
+    //store number of joints
+    int n_joints = model_skeleton.count_joints();
+
+    //frames of root joint, all joints share the same frames
+    std::vector<int> &frames = model_skeleton.root->animation_frames;
+
+    if (uvs.size != 2*vertices.size() || indices.size != 3*faces.size() || face_materials.size != faces.size() || influence_starts.size != vertices.size() + 1 || frame_numbers.size != frames.size() || poses.size != 16*frames.size()*n_joints || texture_info.size != textures.size()) {
+
+        std::cout << "Error, " << DMF_path << " has the wrong number of vertices, faces, frames, joints, or textures\n";
+
+        return false;
+    }
+
+    for (int i = 0; i < vertices.size(); i++) {
+
+        if (uvs[2*i] != static_cast<float>(vertex_uvs[i][0]) || uvs[2*i + 1] != static_cast<float>(vertex_uvs[i][1])) {
+
+            std::cout << "Error, uv of vertex " << i << " in " << DMF_path << " does not match\n";
+
+            return false;
+        }
+
+        if (influence_starts[i] > influence_starts[i + 1] || influence_starts[i + 1] > influences.size) {
+
+            std::cout << "Error, influences of vertex " << i << " in " << DMF_path << " are out of range\n";
+
+            return false;
+        }
+    }
+
+    for (int i = 0; i < faces.size(); i++) {
+
+        if (indices[3*i] != faces[i][0] - 1 || indices[3*i + 1] != faces[i][1] - 1 || indices[3*i + 2] != faces[i][2] - 1 || face_materials[i].texture != face_textures[i] - 1 || face_materials[i].flags != (face_transparency[i] ? 1 : 0)) {
+
+            std::cout << "Error, face " << i << " in " << DMF_path << " does not match\n";
+
+            return false;
+        }
+    }
+
+    for (int i = 0; i < textures.size(); i++) {
+
+        if (texture_info[i].width != textures[i]->width || texture_info[i].height != textures[i]->height || texture_info[i].first_pixel > pixels.size || textures[i]->pixels.size() > pixels.size - texture_info[i].first_pixel || !std::equal(textures[i]->pixels.begin(), textures[i]->pixels.end(), pixels.begin() + texture_info[i].first_pixel)) {
+
+            std::cout << "Error, texture " << i << " in " << DMF_path << " does not match\n";
+
+            return false;
+        }
+    }
+
+    //posed position of current vertex, skinned with the stored matrices
+    double position[3];
+
+    for (int i = 0; i < frames.size(); i++) {
+
+        if (frame_numbers[i] != frames[i]) {
+
+            std::cout << "Error, frame " << i << " in " << DMF_path << " has the wrong frame number\n";
+
+            return false;
+        }
+
+        pose_mesh(frames[i]);
+
+        //world matrices of every joint in this frame
+        const float *frame_poses = poses.begin() + 16*i*n_joints;
+
+        for (int j = 0; j < vertices.size(); j++) {
+
+            position[0] = 0;
+            position[1] = 0;
+            position[2] = 0;
+
+            for (int k = influence_starts[j]; k < influence_starts[j + 1]; k++) {
+
+                const ModelFileInfluence &influence = influences[k];
+
+                if (influence.joint >= n_joints) {
+
+                    std::cout << "Error, vertex " << j << " in " << DMF_path << " is influenced by a joint which does not exist\n";
+
+                    return false;
+                }
+
+                const float *matrix = frame_poses + 16*influence.joint;
+
+                for (int l = 0; l < 3; l++) {
+
+                    position[l] += influence.weight*(matrix[4*l]*influence.position[0] + matrix[4*l + 1]*influence.position[1] + matrix[4*l + 2]*influence.position[2] + matrix[4*l + 3]);
+                }
+            }
+
+            for (int l = 0; l < 3; l++) {
+
+                //matrices and relative positions are stored as floats
+                if (fabs(position[l] - posed_vertices[j][l]) > 1e-4*(1 + fabs(posed_vertices[j][l]))) {
+
+                    std::cout << "Error, vertex " << j << " of frame " << i << " in " << DMF_path << " skins to " << position[l] << " instead of " << posed_vertices[j][l] << "\n";
+
+                    model_skeleton.set_bind_pose();
+
+                    return false;
+                }
+            }
+        }
+    }
+
+    //return skeleton to bind pose so that other exporters can still be used
+    model_skeleton.set_bind_pose();
+
+    return true;
+}
+
+void ModelRipper::to_glb(std::string dest, std::string name) {
+
+    //data for binary chunk
+    std::vector<char> bin;
+
+    //buffer views and accessors describing the binary chunk
+    std::vector<glb_view> views;
+    std::vector<glb_accessor> accessors;
+
+    //start of data currently being added to bin
+    int start;
+
+    //store number of joints
+    int n_joints = model_skeleton.count_joints();
+
+    //temporary vector storage
+    std::vector<double> temp_vec;
+
+    //write vertex positions
+    start = bin.size();
+
+    for (int i = 0; i < vertices.size(); i++) {
+
+        Glb::append<float>(bin, vertices[i][0]);
+        Glb::append<float>(bin, vertices[i][1]);
+        Glb::append<float>(bin, vertices[i][2]);
+    }
+
+    int position_accessor = Glb::add_accessor(accessors, views, bin, start, 5126, "VEC3", vertices.size(), 34962, true);
+
+    //write vertex normals, which gltf requires to have unit length
+    start = bin.size();
+
+    for (int i = 0; i < vertex_normals.size(); i++) {
+
+        temp_vec = normalise(vertex_normals[i]);
+
+        if (temp_vec[0] == 0 && temp_vec[1] == 0 && temp_vec[2] == 0) {
+
+            temp_vec[1] = 1;
+        }
+
+        Glb::append<float>(bin, temp_vec[0]);
+        Glb::append<float>(bin, temp_vec[1]);
+        Glb::append<float>(bin, temp_vec[2]);
+    }
+
+    int normal_accessor = Glb::add_accessor(accessors, views, bin, start, 5126, "VEC3", vertex_normals.size(), 34962, false);
 
     //write vertex uvs
+    //gltf uvs start at the top of the image, while ripped uvs start at the bottom
+    start = bin.size();
+
     for (int i = 0; i < vertex_uvs.size(); i++) {
 
-        DAE << vertex_uvs[i][0] << " " << vertex_uvs[i][1];
+        Glb::append<float>(bin, vertex_uvs[i][0]);
+        Glb::append<float>(bin, 1 - vertex_uvs[i][1]);
+    }
 
-        if (i != vertex_uvs.size()-1) {
+    int uv_accessor = Glb::add_accessor(accessors, views, bin, start, 5126, "VEC2", vertex_uvs.size(), 34962, false);
 
-            DAE << " ";
+    //gltf stores up to 4 joints and weights in each set, so extra sets are used for vertices with more weights
+    int max_weights = 0;
+
+    for (int i = 0; i < vertex_weights.size(); i++) {
+
+        if (vertex_weights[i].size() > max_weights) {
+
+            max_weights = vertex_weights[i].size();
         }
     }
 
-    //need to break up into different materials
-    DAE << "</float_array>\n"
-           "          <technique_common>\n"
-           "            <accessor source=\"#mesh-map-array\" count=\"" << vertex_uvs.size() << "\" stride=\"2\">\n"
-           "              <param name=\"S\" type=\"float\"></param>\n"
-           "              <param name=\"T\" type=\"float\"></param>\n"
-           "            </accessor>\n"
-           "          </technique_common>\n"
-           "        </source>\n"
-           "        <vertices id=\"mesh-vertices\">\n"
-           "          <input semantic=\"POSITION\" source=\"#mesh-positions\"></input>\n"
-           "        </vertices>\n";
-    
-    //previous index at which we stopped adding faces to mesh
-    int prev_index = 0;
+    //accessors for each set of joints and weights
+    std::vector<int> joint_accessors;
+    std::vector<int> weight_accessors;
+
+    //index of weight in vertex_weights
+    int index;
+
+    //sum of vertex weights
+    double total_weight;
+
+    for (int i = 0; i < (max_weights + 3)/4; i++) {
+
+        //write joints
+        start = bin.size();
+
+        for (int j = 0; j < vertex_bones.size(); j++) {
+
+            for (int k = 0; k < 4; k++) {
+
+                index = 4*i + k;
+
+                Glb::append<unsigned short int>(bin, (index < vertex_bones[j].size()) ? vertex_bones[j][index] : 0);
+            }
+        }
+
+        joint_accessors.push_back(Glb::add_accessor(accessors, views, bin, start, 5123, "VEC4", vertex_bones.size(), 34962, false));
+
+        //write weights, which gltf requires to sum to 1
+        start = bin.size();
+
+        for (int j = 0; j < vertex_weights.size(); j++) {
+
+            total_weight = 0;
+
+            for (int k = 0; k < vertex_weights[j].size(); k++) {
+
+                total_weight += vertex_weights[j][k];
+            }
+
+            for (int k = 0; k < 4; k++) {
+
+                index = 4*i + k;
+
+                if (total_weight <= 0) {
+
+                    Glb::append<float>(bin, (index == 0) ? 1 : 0);
+
+                } else {
+
+                    Glb::append<float>(bin, (index < vertex_weights[j].size()) ? vertex_weights[j][index]/total_weight : 0);
+                }
+            }
+        }
+
+        weight_accessors.push_back(Glb::add_accessor(accessors, views, bin, start, 5126, "VEC4", vertex_weights.size(), 34962, false));
+    }
+
+    //group faces by material, so each material is drawn by a single primitive
+    std::vector<int> material_textures;
+    std::vector<bool> material_transparency;
+    std::vector<std::vector<int>> material_faces;
+
+    for (int i = 0; i < faces.size(); i++) {
+
+        index = 0;
+
+        while (index < material_textures.size() && (material_textures[index] != face_textures[i] || material_transparency[index] != face_transparency[i])) {
+
+            index += 1;
+        }
+
+        if (index == material_textures.size()) {
+
+            material_textures.push_back(face_textures[i]);
+            material_transparency.push_back(face_transparency[i]);
+            material_faces.push_back(std::vector<int>());
+        }
+
+        material_faces[index].push_back(i);
+    }
+
+    //write indices for each material, using 16 bit indices when there are few enough vertices
+    bool short_indices = vertices.size() < 65535;
+
+    std::vector<int> index_accessors;
+
+    for (int i = 0; i < material_faces.size(); i++) {
+
+        start = bin.size();
+
+        for (int j = 0; j < material_faces[i].size(); j++) {
+
+            for (int k = 0; k < 3; k++) {
+
+                if (short_indices) {
+
+                    Glb::append<unsigned short int>(bin, faces[material_faces[i][j]][k] - 1);
+
+                } else {
+
+                    Glb::append<unsigned int>(bin, faces[material_faces[i][j]][k] - 1);
+                }
+            }
+        }
+
+        index_accessors.push_back(Glb::add_accessor(accessors, views, bin, start, short_indices ? 5123 : 5125, "SCALAR", 3*material_faces[i].size(), 34963, false));
+    }
+
+    //translation, rotation, and scale of current joint
+    double translation[3];
+    double rotation[4];
+    double scale[3];
+
+    //bind pose of each joint as translation, rotation, and scale
+    std::vector<std::vector<double>> bind_translations;
+    std::vector<std::vector<double>> bind_rotations;
+    std::vector<std::vector<double>> bind_scales;
+
+    //bind pose of each joint rebuilt from its translation, rotation, and scale
+    std::vector<std::vector<double>> bind_transforms;
+
+    for (int i = 0; i < n_joints; i++) {
+
+        Joint *joint = model_skeleton.find_by_order(i);
+
+        //joint space matrix in the layout used by animation matrices
+        std::vector<double> local_transform(16);
+
+        for (int j = 0; j < 16; j++) {
+
+            local_transform[j] = joint->joint_space[j%4][j/4];
+        }
+
+        Matrix::decompose(local_transform, translation, rotation, scale);
+
+        bind_translations.push_back(std::vector<double>(translation, translation + 3));
+        bind_rotations.push_back(std::vector<double>(rotation, rotation + 4));
+        bind_scales.push_back(std::vector<double>(scale, scale + 3));
+
+        bind_transforms.push_back(Matrix::compose(translation, rotation, scale));
+    }
+
+    //write inverse bind matrices
+    //these are calculated from the decomposed joints rather than taken from inverse_transform
+    //gltf cannot store the shear caused by non-uniform parent scaling, so this keeps the bind pose identical to the mesh
+    start = bin.size();
+
+    for (int i = 0; i < n_joints; i++) {
+
+        Joint *joint = model_skeleton.find_by_order(i);
+
+        std::vector<double> world_transform = bind_transforms[i];
+
+        for (Joint *parent = joint->parent; parent != nullptr; parent = parent->parent) {
+
+            world_transform = Matrix::multiply(bind_transforms[parent->order], world_transform);
+        }
+
+        std::vector<double> inverse_bind = Matrix::invert(world_transform);
+
+        //gltf matrices are stored column by column
+        for (int j = 0; j < 4; j++) {
+
+            for (int k = 0; k < 4; k++) {
+
+                Glb::append<float>(bin, inverse_bind[4*k + j]);
+            }
+        }
+    }
+
+    int bind_accessor = Glb::add_accessor(accessors, views, bin, start, 5126, "MAT4", n_joints, 0, false);
+
+    //write animations, with one gltf animation for each clip
+    std::vector<std::vector<glb_channel>> animations;
+
+    //rotation at previous keyframe
+    double prev_rotation[4];
+
+    //frames used by the previous joint, so joints with the same frames can share keyframe times
+    std::vector<int> prev_frames;
+    int prev_input = -1;
+
+    for (int i = 0; i < model_skeleton.clip_starts.size(); i++) {
+
+        animations.push_back(std::vector<glb_channel>());
+
+        prev_frames.clear();
+
+        for (int j = 0; j < n_joints; j++) {
+
+            Joint *joint = model_skeleton.find_by_order(j);
+
+            //keyframes of joint which belong to the current clip
+            std::vector<int> clip_keyframes;
+            std::vector<int> clip_frames;
+
+            for (int k = 0; k < joint->animation_frames.size(); k++) {
+
+                if (joint->animation_frames[k] >= model_skeleton.clip_starts[i] && joint->animation_frames[k] < model_skeleton.clip_starts[i] + model_skeleton.clip_lengths[i]) {
+
+                    clip_keyframes.push_back(k);
+                    clip_frames.push_back(joint->animation_frames[k]);
+                }
+            }
+
+            if (clip_keyframes.size() == 0) continue;
+
+            //write keyframe times, measured from the start of the clip at 30 frames per second
+            if (clip_frames != prev_frames) {
+
+                start = bin.size();
+
+                for (int k = 0; k < clip_frames.size(); k++) {
+
+                    Glb::append<float>(bin, static_cast<float>(clip_frames[k] - model_skeleton.clip_starts[i])/30.0f);
+                }
+
+                prev_input = Glb::add_accessor(accessors, views, bin, start, 5126, "SCALAR", clip_frames.size(), 0, true);
+                prev_frames = clip_frames;
+            }
+
+            glb_channel channel;
+
+            channel.input = prev_input;
+            channel.node = j;
+
+            //decompose each keyframe into separate translation, rotation, and scale outputs
+            std::vector<char> translations;
+            std::vector<char> rotations;
+            std::vector<char> scales;
+
+            for (int k = 0; k < clip_keyframes.size(); k++) {
+
+                Matrix::decompose(joint->animation_matrices[clip_keyframes[k]], translation, rotation, scale);
+
+                //keep quaternions in the same hemisphere so that interpolation takes the shortest path
+                if (k > 0 && rotation[0]*prev_rotation[0] + rotation[1]*prev_rotation[1] + rotation[2]*prev_rotation[2] + rotation[3]*prev_rotation[3] < 0) {
+
+                    for (int l = 0; l < 4; l++) {
+
+                        rotation[l] = -rotation[l];
+                    }
+                }
+
+                for (int l = 0; l < 4; l++) {
+
+                    prev_rotation[l] = rotation[l];
+                }
+
+                for (int l = 0; l < 3; l++) {
+
+                    Glb::append<float>(translations, translation[l]);
+                    Glb::append<float>(scales, scale[l]);
+                }
+
+                for (int l = 0; l < 4; l++) {
+
+                    Glb::append<float>(rotations, rotation[l]);
+                }
+            }
+
+            start = bin.size();
+            bin.insert(bin.end(), translations.begin(), translations.end());
+            channel.output = Glb::add_accessor(accessors, views, bin, start, 5126, "VEC3", clip_keyframes.size(), 0, false);
+            channel.path = "translation";
+            animations.back().push_back(channel);
+
+            start = bin.size();
+            bin.insert(bin.end(), rotations.begin(), rotations.end());
+            channel.output = Glb::add_accessor(accessors, views, bin, start, 5126, "VEC4", clip_keyframes.size(), 0, false);
+            channel.path = "rotation";
+            animations.back().push_back(channel);
+
+            start = bin.size();
+            bin.insert(bin.end(), scales.begin(), scales.end());
+            channel.output = Glb::add_accessor(accessors, views, bin, start, 5126, "VEC3", clip_keyframes.size(), 0, false);
+            channel.path = "scale";
+            animations.back().push_back(channel);
+        }
+
+        //gltf does not allow animations without channels
+        if (animations.back().size() == 0) {
+
+            animations.pop_back();
+        }
+    }
+
+    //write textures as png images
+    //alpha is doubled, since ps2 textures use 0x80 for fully opaque pixels
+    std::vector<int> image_views;
+
+    TexImage image;
+
+    for (int i = 0; i < textures.size(); i++) {
+
+        image = *textures[i];
+
+        for (int j = 0; j < image.pixels.size(); j++) {
+
+            if (image.pixels[j] >= 0x80000000) {
+
+                image.pixels[j] |= 0xFF000000;
+
+            } else {
+
+                image.pixels[j] = (image.pixels[j]&0x00FFFFFF) | ((image.pixels[j]&0xFF000000) << 1);
+            }
+        }
+
+        start = bin.size();
+
+        TexRipper::encode_png(image, bin);
+
+        image_views.push_back(Glb::add_view(views, bin, start, 0));
+    }
+
+    //write json chunk
+    MemoryTarget json_target;
+    OutFile JSON_file(json_target, "json");
+    TextBuffer JSON(JSON_file);
+
+    JSON << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"DOTR Model Ripper\"},"
+            "\"scene\":0,"
+            "\"scenes\":[{\"name\":\"Scene\",\"nodes\":[" << model_skeleton.root->order << "," << n_joints << "]}],";
+
+    //write joint nodes, followed by the mesh node
+    JSON << "\"nodes\":[";
+
+    for (int i = 0; i < n_joints; i++) {
+
+        Joint *joint = model_skeleton.find_by_order(i);
+
+        JSON << "{\"name\":\"joint." << i << "\",\"translation\":[";
+        Glb::write_floats(JSON, bind_translations[i].data(), 3);
+        JSON << "],\"rotation\":[";
+        Glb::write_floats(JSON, bind_rotations[i].data(), 4);
+        JSON << "],\"scale\":[";
+        Glb::write_floats(JSON, bind_scales[i].data(), 3);
+        JSON << "]";
+
+        if (joint->children.size() > 0) {
+
+            JSON << ",\"children\":[";
+
+            for (int j = 0; j < joint->children.size(); j++) {
+
+                if (j != 0) {
+
+                    JSON << ",";
+                }
+
+                JSON << joint->children[j]->order;
+            }
+
+            JSON << "]";
+        }
+
+        JSON << "},";
+    }
+
+    JSON << "{\"name\":\"Mesh\",\"mesh\":0,\"skin\":0}],";
+
+    //write mesh with a primitive for each material
+    JSON << "\"meshes\":[{\"name\":\"Mesh\",\"primitives\":[";
+
+    for (int i = 0; i < material_faces.size(); i++) {
+
+        if (i != 0) {
+
+            JSON << ",";
+        }
+
+        JSON << "{\"attributes\":{\"POSITION\":" << position_accessor << ",\"NORMAL\":" << normal_accessor << ",\"TEXCOORD_0\":" << uv_accessor;
+
+        for (int j = 0; j < joint_accessors.size(); j++) {
+
+            JSON << ",\"JOINTS_" << j << "\":" << joint_accessors[j] << ",\"WEIGHTS_" << j << "\":" << weight_accessors[j];
+        }
+
+        JSON << "},\"indices\":" << index_accessors[i] << ",\"material\":" << i << "}";
+    }
+
+    JSON << "]}],";
+
+    //write skin
+    JSON << "\"skins\":[{\"inverseBindMatrices\":" << bind_accessor << ",\"skeleton\":" << model_skeleton.root->order << ",\"joints\":[";
+
+    for (int i = 0; i < n_joints; i++) {
+
+        if (i != 0) {
+
+            JSON << ",";
+        }
+
+        JSON << i;
+    }
+
+    JSON << "]}],";
+
+    //write materials
+    //ordinary materials use alpha clipping at 0.5, transparent materials use alpha blending
+    JSON << "\"materials\":[";
+
+    for (int i = 0; i < material_textures.size(); i++) {
+
+        if (i != 0) {
+
+            JSON << ",";
+        }
+
+        if (material_transparency[i]) {
+
+            JSON << "{\"name\":\"tex_t." << material_textures[i] << "\",\"alphaMode\":\"BLEND\",";
+
+        } else {
 
-    //produce triangles tags for each section of the mesh with a different material
-    for (int i = 1; i <= faces.size(); i++) {
+            JSON << "{\"name\":\"tex." << material_textures[i] << "\",\"alphaMode\":\"MASK\",\"alphaCutoff\":0.5,";
+        }
 
-        if ((face_textures[i] != face_textures[i-1]) || (face_transparency[i] != face_transparency[i-1]) || (i == faces.size())) {
+        JSON << "\"pbrMetallicRoughness\":{\"metallicFactor\":0,\"roughnessFactor\":1";
 
-            DAE << "        <triangles material=\"tex_";
-            
-            if (face_transparency[i-1]) {
+        //face texture ids start at 1
+        if (material_textures[i] >= 1 && material_textures[i] <= textures.size()) {
 
-                DAE << "t_";
-            }
+            JSON << ",\"baseColorTexture\":{\"index\":" << material_textures[i] - 1 << "}";
+        }
 
-            DAE << face_textures[i-1]-1 << "-material\" count=\"" << i - prev_index << "\">\n"
-                   "          <input semantic=\"VERTEX\" source=\"#mesh-vertices\" offset=\"0\"></input>\n"
-                   "          <input semantic=\"NORMAL\" source=\"#mesh-normals\" offset=\"1\"></input>\n"
-                   "          <input semantic=\"TEXCOORD\" source=\"#mesh-map\" offset=\"2\"></input>\n"
-                   "          <p>";
+        JSON << "}}";
+    }
 
-            for (int j = prev_index; j < i; j++) {
+    JSON << "],";
 
-                DAE << faces[j][0]-1 << " " << faces[j][0]-1 << " " << faces[j][0]-1 << " ";
-                DAE << faces[j][1]-1 << " " << faces[j][1]-1 << " " << faces[j][1]-1 << " ";
-                DAE << faces[j][2]-1 << " " << faces[j][2]-1 << " " << faces[j][2]-1;
+    //write textures, which use mirrored repeat like the game
+    if (textures.size() > 0) {
 
-                if (j != i-1) {
+        JSON << "\"samplers\":[{\"magFilter\":9729,\"minFilter\":9729,\"wrapS\":33648,\"wrapT\":33648}],\"textures\":[";
 
-                    DAE << " ";
-                }
-            }
+        for (int i = 0; i < textures.size(); i++) {
 
-            prev_index = i;
+            if (i != 0) {
 
-            DAE << "</p>\n"
-                   "        </triangles>\n";
+                JSON << ",";
+            }
+
+            JSON << "{\"sampler\":0,\"source\":" << i << "}";
         }
-    }
-    
-    DAE << "      </mesh>\n"
-           "    </geometry>\n"
-           "  </library_geometries>\n";
 
-    //store number of joints
-    int n_joints = model_skeleton.count_joints();
+        JSON << "],\"images\":[";
 
-    //skin mesh
-    DAE << "  <library_controllers>\n"
-           "    <controller id=\"mesh-skin\" name=\"skin\">\n"
-           "      <skin source=\"#mon-mesh\">\n"
-           "        <bind_shape_matrix>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</bind_shape_matrix>\n"
-           "        <source id=\"mesh-skin-joints\">\n"
-           "          <Name_array id=\"mesh-skin-joints-array\" count=\"" << n_joints << "\">";
-    
-    for (int i = 0; i < n_joints; i++) {
+        for (int i = 0; i < image_views.size(); i++) {
 
-        DAE << "joint_" << i;
+            if (i != 0) {
 
-        if (i != n_joints-1) {
+                JSON << ",";
+            }
 
-            DAE << " ";
+            JSON << "{\"name\":\"" << name << "_" << i << "\",\"bufferView\":" << image_views[i] << ",\"mimeType\":\"image/png\"}";
         }
+
+        JSON << "],";
     }
 
-    DAE << "</Name_array>\n"
-           "          <technique_common>\n"
-           "            <accessor source=\"#mesh-skin-joints-array\" count=\"" << n_joints << "\" stride=\"1\">\n"
-           "              <param name=\"JOINT\" type=\"Name\"></param>\n"
-           "            </accessor>\n"
-           "          </technique_common>\n"
-           "        </source>\n"
-           "        <source id=\"mesh-skin-bind_poses\">\n"
-           "          <float_array id=\"mesh-skin-bind_poses-array\" count=\"" << 16*n_joints << "\">";
-    
-    DAE << model_skeleton.pose_array_collada();
+    //write animations
+    if (animations.size() > 0) {
 
-    DAE << "</float_array>\n"
-           "          <technique_common>\n"
-           "            <accessor source=\"#mesh-skin-bind_poses-array\" count=\"" << n_joints << "\" stride=\"16\">\n"
-           "              <param name=\"TRANSFORM\" type=\"float4x4\"></param>\n"
-           "            </accessor>\n"
-           "          </technique_common>\n"
-           "        </source>\n";
-    
+        JSON << "\"animations\":[";
 
-    //count number of vertex weights
-    int n_weights = 0;
+        for (int i = 0; i < animations.size(); i++) {
 
-    for (int i = 0; i < vertex_weights.size(); i++) {
+            if (i != 0) {
 
-        n_weights += vertex_weights[i].size();
-    }
+                JSON << ",";
+            }
 
-    DAE << "        <source id=\"mesh-skin-weights\">\n"
-           "          <float_array id=\"mesh-skin-weights-array\" count=\"" << n_weights << "\">";
-    
-    for (int i = 0; i < vertex_weights.size(); i++) {
+            JSON << "{\"name\":\"animation." << i << "\",\"samplers\":[";
 
-        for (int j = 0; j < vertex_weights[i].size(); j++) {
+            for (int j = 0; j < animations[i].size(); j++) {
 
-            DAE << vertex_weights[i][j];
+                if (j != 0) {
 
-            if (j != vertex_weights[i].size()-1) {
+                    JSON << ",";
+                }
 
-                DAE << " ";
+                JSON << "{\"input\":" << animations[i][j].input << ",\"output\":" << animations[i][j].output << ",\"interpolation\":\"LINEAR\"}";
             }
-        }
 
-        if (i != vertex_weights.size()-1) {
+            JSON << "],\"channels\":[";
 
-            DAE << " ";
+            for (int j = 0; j < animations[i].size(); j++) {
+
+                if (j != 0) {
+
+                    JSON << ",";
+                }
+
+                JSON << "{\"sampler\":" << j << ",\"target\":{\"node\":" << animations[i][j].node << ",\"path\":\"" << animations[i][j].path << "\"}}";
+            }
+
+            JSON << "]}";
         }
-    }
 
-    DAE << "</float_array>\n"
-           "          <technique_common>\n"
-           "            <accessor source=\"#mesh-skin-weights-array\" count=\"" << n_weights << "\" stride=\"1\">\n"
-           "              <param name=\"WEIGHT\" type=\"float\"></param>\n"
-           "            </accessor>\n"
-           "          </technique_common>\n"
-           "        </source>\n"
-           "        <joints>\n"
-           "          <input semantic=\"JOINT\" source=\"#mesh-skin-joints\"></input>\n"
-           "          <input semantic=\"INV_BIND_MATRIX\" source=\"#mesh-skin-bind_poses\"></input>\n"
-           "        </joints>\n"
-           "        <vertex_weights count=\"" << vertex_weights.size() << "\">\n"
-           "          <input semantic=\"JOINT\" source=\"#mesh-skin-joints\" offset=\"0\"></input>\n"
-           "          <input semantic=\"WEIGHT\" source=\"#mesh-skin-weights\" offset=\"1\"></input>\n"
-           "          <vcount>";
+        JSON << "],";
+    }
 
-    //write number of weights for each vertex
-    for (int i = 0; i < vertex_weights.size(); i++) {
+    //write accessors
+    JSON << "\"accessors\":[";
 
-        DAE << vertex_weights[i].size();
+    for (int i = 0; i < accessors.size(); i++) {
 
-        if (i != vertex_weights.size()-1) {
+        if (i != 0) {
 
-            DAE << " ";
+            JSON << ",";
         }
-    }
 
-    DAE << "</vcount>\n"
-           "          <v>";
+        JSON << "{\"bufferView\":" << accessors[i].view << ",\"componentType\":" << accessors[i].component_type << ",\"count\":" << accessors[i].count << ",\"type\":\"" << accessors[i].type << "\"";
 
-    //tracks current index
-    int counter = 0;
+        if (accessors[i].min.size() > 0) {
 
-    //write each joint index and associated weight index for each vertex
-    for (int i = 0; i < vertex_weights.size(); i++) {
+            JSON << ",\"min\":[";
 
-        for (int j = 0; j < vertex_weights[i].size(); j++) {
+            for (int j = 0; j < accessors[i].min.size(); j++) {
 
-            DAE << vertex_bones[i][j] << " " << counter;
+                if (j != 0) {
 
-            if (j != vertex_weights[i].size()-1) {
+                    JSON << ",";
+                }
 
-                DAE << " ";
+                JSON.write_exact(accessors[i].min[j]);
             }
 
-            counter += 1;
-        }
+            JSON << "],\"max\":[";
 
-        if (i != vertex_weights.size()-1) {
+            for (int j = 0; j < accessors[i].max.size(); j++) {
 
-            DAE << " ";
+                if (j != 0) {
+
+                    JSON << ",";
+                }
+
+                JSON.write_exact(accessors[i].max[j]);
+            }
+
+            JSON << "]";
         }
+
+        JSON << "}";
     }
 
+    //write buffer views
+    JSON << "],\"bufferViews\":[";
 
-    DAE << "</v>\n"
-           "        </vertex_weights>\n"
-           "      </skin>\n"
-           "    </controller>\n"
-           "  </library_controllers>\n";
+    for (int i = 0; i < views.size(); i++) {
 
-    //write skeleton
-    DAE << "  <library_visual_scenes>\n"
-           "    <visual_scene id=\"Scene\" name=\"Scene\">\n"
-           "      <node id=\"Armature\" name=\"Armature\" type=\"NODE\">\n"
-           "        <matrix sid=\"transform\">1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</matrix>\n";
-    
-    DAE << model_skeleton.collada(4);
+        if (i != 0) {
 
-    DAE << "      </node>\n";
+            JSON << ",";
+        }
 
-    //write controller node
-    DAE << "      <node id=\"mesh\" name=\"Mesh\">\n"
-           "        <instance_controller url=\"#mesh-skin\">\n"
-           "          <skeleton>#Armature</skeleton>"
-           "          <bind_material>\n"
-           "            <technique_common>\n";
+        JSON << "{\"buffer\":0,\"byteOffset\":" << views[i].offset << ",\"byteLength\":" << views[i].length;
 
-    for (int i = 0; i < texture_count; i++) {
+        if (views[i].target != 0) {
 
-        //normal mesh material
-        DAE << "              <instance_material symbol=\"tex_" << i << "-material\" target=\"#tex_" << i << "-material\">\n"
-               "                <bind_vertex_input semantic=\"UVMap\" input_semantic=\"TEXCOORD\" input_set=\"0\"/>\n"
-               "              </instance_material>\n";
-        
-        //transparent mesh material
-        DAE << "              <instance_material symbol=\"tex_t_" << i << "-material\" target=\"#tex_t_" << i << "-material\">\n"
-               "                <bind_vertex_input semantic=\"UVMap\" input_semantic=\"TEXCOORD\" input_set=\"0\"/>\n"
-               "              </instance_material>\n";
+            JSON << ",\"target\":" << views[i].target;
+        }
+
+        JSON << "}";
     }
 
-    DAE << "            </technique_common>\n"
-           "          </bind_material>\n"
-           "        </instance_controller>\n"
-           "      </node>\n"
-           "    </visual_scene>\n"
-           "  </library_visual_scenes>\n"
-           "  <library_animations>\n";
+    JSON << "],\"buffers\":[{\"byteLength\":" << bin.size() << "}]}";
 
-    DAE << model_skeleton.animation_collada();
+    JSON_file.close();
 
-    DAE << "  </library_animations>\n"
-           "  <scene>\n"
-           "    <instance_visual_scene url=\"#Scene\"/>\n"
-           "  </scene>\n"
-           "</COLLADA>";
+    std::vector<char> &json = json_target.files["json"];
+
+    //json chunk is padded with spaces
+    while (json.size()%4 != 0) {
+
+        json.push_back(' ');
+    }
+
+    //write glb file
+    OutFile GLB_file(dest + name + ".glb");
 
-    DAE.close();
+    //glb header, chunk header, and chunk data for json and binary chunks
+    std::vector<char> header;
+
+    Glb::append<unsigned int>(header, 0x46546C67);
+    Glb::append<unsigned int>(header, 2);
+    Glb::append<unsigned int>(header, 12 + 8 + json.size() + 8 + bin.size());
+
+    Glb::append<unsigned int>(header, json.size());
+    Glb::append<unsigned int>(header, 0x4E4F534A);
+
+    GLB_file.write(header.data(), header.size());
+    GLB_file.write(json.data(), json.size());
+
+    header.clear();
+
+    Glb::append<unsigned int>(header, bin.size());
+    Glb::append<unsigned int>(header, 0x004E4942);
+
+    GLB_file.write(header.data(), header.size());
+    GLB_file.write(bin.data(), bin.size());
+
+    GLB_file.close();
 }
 
 void ModelRipper::reset() {
@@ -859,9 +2574,16 @@ void ModelRipper::reset() {
     vertex_uvs.clear();
     vertex_bones.clear();
     vertex_weights.clear();
+    vertex_joints.clear();
+    vertex_local_positions.clear();
+    vertex_local_normals.clear();
+    posed_vertices.clear();
+    posed_normals.clear();
     faces.clear();
     face_textures.clear();
     face_transparency.clear();
+    textures.clear();
+    texture_hashes.clear();
     joints_in_use.clear();
     joint_refs.clear();
     vertex_counter = 1;
@@ -936,13 +2658,7 @@ void ModelRipper::get_mesh_via_map(char *buf, int base, int map_offset, int mesh
     //offset to current texture
     int curr_tex_offset;
 
-    //string for storing reused texture filename
-    std::string tex_filename;
-
-    //ifstream variable used to test if texture already exists
-    std::ifstream existing_tex;
-
-    //rip textures used by model
+    //decode textures used by model
     for (int i = 0; i < n_tex; i++) {
 
         curr_tex_offset = reinterpret_cast<int *>(buf + base + tex_table_offset)[0];
@@ -953,15 +2669,37 @@ void ModelRipper::get_mesh_via_map(char *buf, int base, int map_offset, int mesh
             curr_tex_offset = tex_offset;
         }
 
-        tex_filename = "models/" + std::to_string(base/0x100000) + " - " + MON_NAMES_LIST[base/0x100000] + "/" + std::to_string(base/0x100000) + "_" + std::to_string(i) + ".bmp";
+        texture_hashes.push_back(TexRipper::hash(buf, base + curr_tex_offset));
+
+        std::map<unsigned long long, std::shared_ptr<const TexImage>>::iterator cached = texture_cache.find(texture_hashes.back());
+
+        //texture has already been decoded for another model, and is shared with it
+        if (cached != texture_cache.end()) {
+
+            textures.push_back(cached->second);
+
+        } else {
+
+            //decode into the thread's scratch image, then copy the result once into storage sized to fit
+            const TexImage *decoded = TexRipper::decode(buf, base + curr_tex_offset);
+
+            textures.push_back((decoded != nullptr) ? std::make_shared<const TexImage>(*decoded) : std::make_shared<const TexImage>());
 
-        //check if texture file already exists
-        existing_tex = std::ifstream(tex_filename);
+            //blocks which are not textures are not cached, as they all have the same hash
+            if (texture_hashes.back() != 0) {
 
-        if (!existing_tex.good()) {
+                texture_cache[texture_hashes.back()] = textures.back();
+                texture_cache_order.push_back(texture_hashes.back());
+                texture_cache_used += textures.back()->pixels.size()*sizeof(unsigned int) + textures.back()->indices.size();
 
-            //texture file does not exist, rip the corresponding texture
-            TexRipper::rip(buf, base + curr_tex_offset, tex_filename);
+                //remove oldest textures until cache fits, models still using them keep their own reference
+                while (texture_cache_used > TEXTURE_CACHE_SIZE && texture_cache_order.size() > 1) {
+
+                    texture_cache_used -= texture_cache[texture_cache_order.front()]->pixels.size()*sizeof(unsigned int) + texture_cache[texture_cache_order.front()]->indices.size();
+                    texture_cache.erase(texture_cache_order.front());
+                    texture_cache_order.pop_front();
+                }
+            }
         }
 
         tex_table_offset += 0x10;
@@ -1204,6 +2942,13 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
     //vector of bones for current vertex
     std::vector<int> curr_bones;
 
+    //vector of joints for current vertex
+    std::vector<Joint *> curr_joints;
+
+    //untransformed positions and normals for each joint used by current vertex
+    std::vector<double> curr_local_pos;
+    std::vector<double> curr_local_norm;
+
     //currently used joint
     Joint *curr_joint;
 
@@ -1251,6 +2996,7 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
 
             curr_weight_vec.push_back(1.0);
             curr_bones.push_back(curr_joint->get_order());
+            curr_joints.push_back(curr_joint);
 
             for (int i = 0; i < n_vertices; i++) {
 
@@ -1269,6 +3015,9 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                 curr_norm[1] = static_cast<double>(curr_vert1->y_norm)/32768.0;
                 curr_norm[2] = static_cast<double>(curr_vert1->z_norm)/32768.0;
 
+                //store untransformed normal
+                vertex_local_normals.push_back(curr_norm);
+
                 //apply transformation
                 curr_norm = curr_joint->transform_vector(curr_norm);
 
@@ -1283,6 +3032,9 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                 curr_pos[1] = static_cast<double>(curr_vert1->y_pos);
                 curr_pos[2] = static_cast<double>(curr_vert1->z_pos);
 
+                //store untransformed position
+                vertex_local_positions.push_back(curr_pos);
+
                 //apply transformation
                 curr_pos = curr_joint->transform_vertex(curr_pos);
                     
@@ -1292,6 +3044,7 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                 //push weight and bone vectors
                 vertex_weights.push_back(curr_weight_vec);
                 vertex_bones.push_back(curr_bones);
+                vertex_joints.push_back(curr_joints);
 
                 //update face vector
                 curr_face[0] = curr_face[1];
@@ -1312,6 +3065,7 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
             //reset vectors
             curr_weight_vec.clear();
             curr_bones.clear();
+            curr_joints.clear();
 
         } else if (submesh_type == 2) {
 
@@ -1360,12 +3114,16 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                     //push bone order and weight to vectors
                     curr_weight_vec.push_back(curr_weight);
                     curr_bones.push_back(curr_joint->get_order());
+                    curr_joints.push_back(curr_joint);
 
                     //extract normal
                     curr_subnorm[0] = static_cast<double>(curr_vert2->x_norm)/32768.0;
                     curr_subnorm[1] = static_cast<double>(curr_vert2->y_norm)/32768.0;
                     curr_subnorm[2] = static_cast<double>(curr_vert2->z_norm)/32768.0;
 
+                    //store untransformed normal
+                    curr_local_norm.insert(curr_local_norm.end(), curr_subnorm.begin(), curr_subnorm.end());
+
                     //apply transformation
                     curr_subnorm = curr_joint->transform_vector(curr_subnorm);
 
@@ -1374,6 +3132,9 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                     curr_subpos[1] = static_cast<double>(curr_vert2->y_pos);
                     curr_subpos[2] = static_cast<double>(curr_vert2->z_pos);
 
+                    //store untransformed position
+                    curr_local_pos.insert(curr_local_pos.end(), curr_subpos.begin(), curr_subpos.end());
+
                     //apply transformation
                     curr_subpos = curr_joint->transform_vertex(curr_subpos);
 
@@ -1394,9 +3155,12 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                 vertex_normals.push_back(curr_norm);
                 vertices.push_back(curr_pos);
 
-                //push weight and bone vectors
+                //push weight, bone, and joint vectors
                 vertex_weights.push_back(curr_weight_vec);
                 vertex_bones.push_back(curr_bones);
+                vertex_joints.push_back(curr_joints);
+                vertex_local_positions.push_back(curr_local_pos);
+                vertex_local_normals.push_back(curr_local_norm);
 
                 //update face vector
                 curr_face[0] = curr_face[1];
@@ -1412,6 +3176,9 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
                 //reset vectors
                 curr_weight_vec.clear();
                 curr_bones.clear();
+                curr_joints.clear();
+                curr_local_pos.clear();
+                curr_local_norm.clear();
 
                 //update counters
                 vertex_counter += 1;
@@ -1420,6 +3187,47 @@ void ModelRipper::get_mesh(char *buf, int base, int region_offset, int region_si
     }
 }
 
+void ModelRipper::pose_mesh(int frame) {
+
+    //vectors for storing partial positions and normals
+    std::vector<double> curr_subpos(3);
+    std::vector<double> curr_subnorm(3);
+
+    //weight of current joint
+    double curr_weight;
+
+    //update skeleton to match frame
+    model_skeleton.set_frame(frame);
+
+    posed_vertices.assign(vertices.size(), std::vector<double>(3, 0));
+    posed_normals.assign(vertices.size(), std::vector<double>(3, 0));
+
+    //skin each vertex using the same weighted sum as get_mesh
+    for (int i = 0; i < vertices.size(); i++) {
+
+        for (int j = 0; j < vertex_joints[i].size(); j++) {
+
+            curr_weight = vertex_weights[i][j];
+
+            curr_subpos.assign(vertex_local_positions[i].begin() + 3*j, vertex_local_positions[i].begin() + 3*j + 3);
+            curr_subnorm.assign(vertex_local_normals[i].begin() + 3*j, vertex_local_normals[i].begin() + 3*j + 3);
+
+            //apply transformations
+            curr_subpos = vertex_joints[i][j]->transform_vertex(curr_subpos);
+            curr_subnorm = vertex_joints[i][j]->transform_vector(curr_subnorm);
+
+            for (int k = 0; k < 3; k++) {
+
+                posed_vertices[i][k] += curr_weight*curr_subpos[k];
+                posed_normals[i][k] += curr_weight*curr_subnorm[k];
+            }
+        }
+
+        //normalise vector
+        posed_normals[i] = normalise(posed_normals[i]);
+    }
+}
+
 Joint *ModelRipper::find_by_ref(unsigned short int reference) {
 
     //find reference in vector, then return corresponding joint pointer
@@ -1432,6 +3240,52 @@ Joint *ModelRipper::find_by_ref(unsigned short int reference) {
     return nullptr;
 }
 
+void ModelRipper::get_frame_positions(std::vector<std::vector<float>> &frame_positions, std::vector<int> &clip_starts, std::vector<int> &clip_lengths) {
+
+    //frames of root joint, all joints share the same frames
+    std::vector<int> &frames = model_skeleton.root->animation_frames;
+
+    frame_positions.assign(frames.size(), std::vector<float>(3*vertices.size()));
+
+    for (int i = 0; i < frames.size(); i++) {
+
+        pose_mesh(frames[i]);
+
+        for (int j = 0; j < vertices.size(); j++) {
+
+            frame_positions[i][3*j] = posed_vertices[j][0];
+            frame_positions[i][3*j + 1] = posed_vertices[j][1];
+            frame_positions[i][3*j + 2] = posed_vertices[j][2];
+        }
+    }
+
+    //return skeleton to bind pose so that other exporters can still be used
+    model_skeleton.set_bind_pose();
+
+    //convert clips to indices in frames
+    clip_starts.clear();
+    clip_lengths.clear();
+
+    for (int i = 0; i < model_skeleton.clip_starts.size(); i++) {
+
+        clip_starts.push_back(0);
+        clip_lengths.push_back(0);
+
+        for (int j = 0; j < frames.size(); j++) {
+
+            if (frames[j] >= model_skeleton.clip_starts[i] && frames[j] < model_skeleton.clip_starts[i] + model_skeleton.clip_lengths[i]) {
+
+                if (clip_lengths.back() == 0) {
+
+                    clip_starts.back() = j;
+                }
+
+                clip_lengths.back() += 1;
+            }
+        }
+    }
+}
+
 void ModelRipper::add_aligned_face(std::vector<int> face) {
 
     int temp;
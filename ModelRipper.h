@@ -1,7 +1,12 @@
+#include<deque>
+#include<map>
+#include<memory>
 #include<vector>
 #include<string>
 #include "Skeleton.h"
 #include "Joint.h"
+#include "TexRipper.h"
+#include "TextureRegistry.h"
 
 #ifndef MODELRIPPER_H
 #define MODELRIPPER_H
@@ -16,7 +21,35 @@ public:
     static void rip(char *buf, int base);
 
     //output each frame of animation as a separate obj file
-    static void animations_as_obj(char *buf, int base, std::string dest, std::string name);
+    //if shared_topology is true, frame files only contain vertex positions (and normals if write_normals is true)
+    //in the same order as the obj file from to_obj, which holds the uvs, faces, and materials for all frames
+    static void animations_as_obj(std::string dest, std::string name, bool shared_topology = false, bool write_normals = false);
+
+    //output each animation clip as a .pc2 point cache of vertex positions, for use with the obj file from to_obj
+    //vertex normals are written to a second point cache if write_normals is true
+    static void animations_as_pc2(std::string dest, std::string name, bool write_normals = false);
+
+    //output all animation frames as a delta encoded frame stream, for use with the obj file from to_obj
+    static void animations_as_stream(std::string dest, std::string name);
+
+    //reads the frame stream written by animations_as_stream back with FrameStreamReader, and checks its clips and every frame against the posed mesh
+    //frames are read from last to first, so that every frame is reached by seeking to a keyframe
+    //returns false, after printing the first difference, if the stream does not match
+    static bool verify_stream(std::string dest, std::string name);
+
+    //output each animation clip as vertex animation textures, with a .json file describing them
+    //each row of a texture holds the posed position or normal of every vertex for one frame, in the order used by the obj file from to_obj
+    //textures are 16 bit .png files scaled to the bounds in the .json file, or .pfm files holding 32 bit floats if float_images is true
+    static void animations_as_vat(std::string dest, std::string name, bool float_images = false);
+
+    //output textures used by model to files in texture_format
+    static void write_textures(std::string dest, std::string name);
+
+    //combines the textures used by model into a single texture, so that the model has one opaque and one transparent material
+    //each texture is copied as many times as its uvs repeat it, mirrored in the same way as the "Mirror" repeat option, with a mirrored border to prevent filtering from reading neighbouring textures
+    //uvs are changed to point into the combined texture, and faces are ordered so that opaque faces come before transparent faces
+    //returns false, leaving the model unchanged, if a vertex is shared by faces with different textures or the combined texture would be too large
+    static bool build_atlas();
 
     //generate material library file for use by obj files
     static void generate_mtl(std::string dest, std::string name);
@@ -24,12 +57,38 @@ public:
     //outputs model data to obj format
     static void to_obj(std::string dest, std::string name, int frame = -1);
 
+    //outputs posed vertex positions, and normals if write_normals is true, to an obj file for the given frame
+    static void to_obj_vertices(std::string dest, std::string name, int frame, bool write_normals);
+
     //outputs model with skeleton and animations to collada
     static void to_collada(std::string out_path, std::string name);
 
+    //outputs model, skeleton, skin, posed joint matrices for every frame, and textures to a memory mappable container, described in ModelFile.h
+    static void to_dmf(std::string dest, std::string name);
+
+    //maps the .dmf file written by to_dmf with ModelFileReader, and checks its uvs, faces, and textures against the model
+    //every posed frame is rebuilt by skinning the vertices with the stored joint matrices, and checked against the posed mesh
+    //returns false, after printing the first difference, if the file does not match
+    static bool verify_dmf(std::string dest, std::string name);
+
+    //outputs model with skeleton, animations, and embedded textures to binary gltf
+    static void to_glb(std::string dest, std::string name);
+
     //resets variables
     static void reset();
 
+    //format of texture files written by write_textures and referenced by mtl and dae files, one of the TexRipper formats
+    static int texture_format;
+
+    //width of the mirrored border around each texture in an atlas, in pixels
+    static const int ATLAS_PADDING = 8;
+
+    //maximum number of times a texture may be repeated in each direction in an atlas
+    static const int ATLAS_MAX_REPEATS = 4;
+
+    //maximum width and height of an atlas, in pixels
+    static const int ATLAS_MAX_SIZE = 4096;
+
 private:
 
     //skeleton used by model
@@ -50,6 +109,21 @@ private:
     //vector of vectors of weights for each bone in vertex_bones
     static std::vector<std::vector<double>> vertex_weights;
 
+    //vector of vectors of pointers to the joint for each bone in vertex_bones
+    static std::vector<std::vector<Joint *>> vertex_joints;
+
+    //untransformed position of each vertex relative to each joint in vertex_joints, stored as xyz triplets
+    static std::vector<std::vector<double>> vertex_local_positions;
+
+    //untransformed normal of each vertex relative to each joint in vertex_joints, stored as xyz triplets
+    static std::vector<std::vector<double>> vertex_local_normals;
+
+    //vector of vertices in model at the currently posed frame
+    static std::vector<std::vector<double>> posed_vertices;
+
+    //vector of vertex normals in model at the currently posed frame
+    static std::vector<std::vector<double>> posed_normals;
+
     //vector of faces in model
     static std::vector<std::vector<int>> faces;
 
@@ -59,6 +133,28 @@ private:
     //transparency flag for each face
     static std::vector<bool> face_transparency;
 
+    //decoded textures used by model, shared with texture_cache
+    static std::vector<std::shared_ptr<const TexImage>> textures;
+
+    //hash of the texture block of each texture used by model, from TexRipper::hash
+    static std::vector<unsigned long long> texture_hashes;
+
+    //decoded textures by hash, kept between models so that textures shared between monsters are only decoded once
+    //oldest textures are removed once the total size exceeds TEXTURE_CACHE_SIZE bytes
+    static std::map<unsigned long long, std::shared_ptr<const TexImage>> texture_cache;
+
+    //hashes in texture_cache, oldest first
+    static std::deque<unsigned long long> texture_cache_order;
+
+    //total size of pixel and index data in texture_cache
+    static size_t texture_cache_used;
+
+    //maximum size of pixel and index data in texture_cache
+    static const size_t TEXTURE_CACHE_SIZE = 128 << 20;
+
+    //texture files written during the run, used to skip or link textures without checking the output target
+    static TextureRegistry texture_registry;
+
     //vector of pointers to joints used in mesh region
     static std::vector<Joint *> joints_in_use;
 
@@ -94,9 +190,16 @@ private:
     //joints_in_use and joint_refs
     static void get_mesh(char *buf, int base, int region_offset, int region_size);
 
+    //sets skeleton to frame and fills posed_vertices and posed_normals from the bind mesh
+    static void pose_mesh(int frame);
+
     //obtains the pointer to the joint with matching reference ID among joints_in_use
     static Joint *find_by_ref(unsigned short int reference);
 
+    //fills frame_positions with the posed vertex positions of each animation frame as xyz triplets
+    //and clip_starts and clip_lengths with the range of frames in each clip, as indices into frame_positions
+    static void get_frame_positions(std::vector<std::vector<float>> &frame_positions, std::vector<int> &clip_starts, std::vector<int> &clip_lengths);
+
     //adds correctly ordered face to faces vector to ensure correct alignment of normals
     static void add_aligned_face(std::vector<int> face);
 };
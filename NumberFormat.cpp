@@ -0,0 +1,109 @@
+#include "NumberFormat.h"
+#include<charconv>
+#include<string>
+
+//define static variables
+
+//selected style, -1 if each writer's default style should be used
+int NumberFormat::selected_style = -1;
+
+//number of digits used by GENERAL and FIXED styles
+int NumberFormat::selected_precision = 6;
+
+void NumberFormat::select(int style, int precision) {
+
+    selected_style = style;
+    selected_precision = precision;
+}
+
+bool NumberFormat::select(std::string name) {
+
+    //style and number of digits given by name
+    int style;
+    int precision = 6;
+
+    //length of the style part of name
+    int name_length;
+
+    if (name.compare(0, 8, "shortest") == 0) {
+
+        style = SHORTEST;
+        name_length = 8;
+
+    } else if (name.compare(0, 5, "fixed") == 0) {
+
+        style = FIXED;
+        name_length = 5;
+
+    } else if (name.compare(0, 7, "general") == 0) {
+
+        style = GENERAL;
+        name_length = 7;
+
+    } else {
+
+        return false;
+    }
+
+    //read optional precision
+    if (name.size() > name_length) {
+
+        std::from_chars_result result = std::from_chars(name.data() + name_length, name.data() + name.size(), precision);
+
+        if (result.ec != std::errc() || result.ptr != name.data() + name.size() || precision < 0 || precision > 17) {
+
+            return false;
+        }
+    }
+
+    select(style, precision);
+
+    return true;
+}
+
+char *NumberFormat::write(char *out, double value, int default_style) {
+
+    //style and precision used for this value
+    int style = default_style;
+    int precision = 6;
+
+    if (selected_style != -1) {
+
+        style = selected_style;
+        precision = selected_precision;
+    }
+
+    if (style == SHORTEST) {
+
+        return std::to_chars(out, out + MAX_LENGTH, value).ptr;
+    }
+
+    if (style == FIXED) {
+
+        return std::to_chars(out, out + MAX_LENGTH, value, std::chars_format::fixed, precision).ptr;
+    }
+
+    return std::to_chars(out, out + MAX_LENGTH, value, std::chars_format::general, precision).ptr;
+}
+
+char *NumberFormat::write_exact(char *out, float value) {
+
+    return std::to_chars(out, out + MAX_LENGTH, value).ptr;
+}
+
+char *NumberFormat::write(char *out, long long value) {
+
+    return std::to_chars(out, out + MAX_LENGTH, value).ptr;
+}
+
+char *NumberFormat::write(char *out, unsigned long long value) {
+
+    return std::to_chars(out, out + MAX_LENGTH, value).ptr;
+}
+
+std::string NumberFormat::to_string(double value, int default_style) {
+
+    char out[MAX_LENGTH];
+
+    return std::string(out, write(out, value, default_style));
+}
@@ -0,0 +1,54 @@
+#include<string>
+
+#ifndef NUMBERFORMAT_H
+#define NUMBERFORMAT_H
+
+class NumberFormat {
+
+public:
+
+    //floating point styles
+    //GENERAL: precision significant digits, matches std::ostream output
+    //FIXED: precision digits after the decimal point, matches std::to_string output
+    //SHORTEST: fewest digits which read back as exactly the same value
+    static const int GENERAL = 0;
+    static const int FIXED = 1;
+    static const int SHORTEST = 2;
+
+    //maximum number of chars produced by a single write
+    static const int MAX_LENGTH = 400;
+
+    //selects the style used for all floating point output, overriding the default style of each writer
+    static void select(int style, int precision);
+
+    //selects style from a name such as "shortest", "fixed6", or "general9"
+    //returns false if the name is not recognised
+    static bool select(std::string name);
+
+    //writes value to out using default_style, unless a style has been selected
+    //out must have room for MAX_LENGTH chars, returns pointer to the end of the written chars
+    static char *write(char *out, double value, int default_style = GENERAL);
+
+    //writes the shortest text which reads back as exactly the same single precision value, ignoring the selected style
+    //used where output must match binary data exactly
+    //out must have room for MAX_LENGTH chars, returns pointer to the end of the written chars
+    static char *write_exact(char *out, float value);
+
+    //writes integer value to out
+    //out must have room for MAX_LENGTH chars, returns pointer to the end of the written chars
+    static char *write(char *out, long long value);
+    static char *write(char *out, unsigned long long value);
+
+    //returns value as a string using default_style, unless a style has been selected
+    static std::string to_string(double value, int default_style = GENERAL);
+
+private:
+
+    //selected style, -1 if each writer's default style should be used
+    static int selected_style;
+
+    //number of digits used by GENERAL and FIXED styles
+    static int selected_precision;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "OutFile.h"
+#include "OutputTarget.h"
+#include<cstring>
+#include<string>
+#include<vector>
+
+//define static variables
+
+//buffers returned by closed OutFiles
+thread_local std::vector<std::vector<char>> OutFile::spare_buffers;
+
+OutFile::OutFile(std::string path, size_t capacity):OutFile(OutputTarget::get_default(), path, capacity) {}
+
+OutFile::OutFile(OutputTarget &target, std::string path, size_t capacity):target(target) {
+
+    id = target.open(path);
+
+    //reuse a spare buffer if one is available
+    if (spare_buffers.size() > 0) {
+
+        buffer = std::move(spare_buffers.back());
+        spare_buffers.pop_back();
+    }
+
+    if (buffer.size() < capacity) {
+
+        buffer.resize(capacity);
+    }
+}
+
+OutFile::~OutFile() {
+
+    close();
+}
+
+void OutFile::write(const char *data, size_t size) {
+
+    //data larger than the buffer is passed on directly
+    if (size > buffer.size()) {
+
+        flush();
+        target.write(id, data, size);
+
+        return;
+    }
+
+    std::memcpy(reserve(size), data, size);
+    used += size;
+}
+
+char *OutFile::reserve(size_t size) {
+
+    if (buffer.size() - used < size) {
+
+        flush();
+    }
+
+    //grow buffer if a single reservation is larger than it
+    if (buffer.size() < size) {
+
+        buffer.resize(size);
+    }
+
+    return buffer.data() + used;
+}
+
+void OutFile::commit(size_t size) {
+
+    used += size;
+}
+
+void OutFile::flush() {
+
+    if (used > 0) {
+
+        target.write(id, buffer.data(), used);
+        used = 0;
+    }
+}
+
+bool OutFile::close() {
+
+    if (!is_open) return true;
+
+    flush();
+
+    bool written = target.close(id);
+
+    is_open = false;
+
+    //return buffer for reuse
+    spare_buffers.push_back(std::move(buffer));
+
+    return written;
+}
@@ -0,0 +1,61 @@
+#include<string>
+#include<vector>
+#include "OutputTarget.h"
+
+#ifndef OUTFILE_H
+#define OUTFILE_H
+
+//buffered output file
+//data is collected in a large buffer and passed to the output target in as few writes as possible
+class OutFile {
+
+public:
+
+    //opens path in the default output target
+    OutFile(std::string path, size_t capacity = 1 << 20);
+
+    //opens path in target
+    OutFile(OutputTarget &target, std::string path, size_t capacity = 1 << 20);
+
+    //closes the file if it is still open
+    ~OutFile();
+
+    //appends data to the file
+    void write(const char *data, size_t size);
+
+    //returns pointer to at least size bytes of free buffer space
+    //the space is added to the file by commit
+    char *reserve(size_t size);
+
+    //adds size bytes, written to the space returned by reserve, to the file
+    void commit(size_t size);
+
+    //passes buffered data to the output target
+    void flush();
+
+    //flushes and finishes the file
+    //returns false if the target could not write the file, targets which write files later report failures through OutputTarget::record_failure instead
+    bool close();
+
+private:
+
+    //target the file is written to
+    OutputTarget &target;
+
+    //id of file in target
+    int id;
+
+    //true until close is called
+    bool is_open = true;
+
+    //buffered data
+    std::vector<char> buffer;
+
+    //number of bytes in buffer
+    size_t used = 0;
+
+    //buffers returned by closed OutFiles, reused to avoid repeated large allocations
+    static thread_local std::vector<std::vector<char>> spare_buffers;
+};
+
+#endif
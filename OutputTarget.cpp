@@ -0,0 +1,228 @@
+#include "OutputTarget.h"
+#include<cstdio>
+#include<filesystem>
+#include<iostream>
+#include<map>
+#include<mutex>
+#include<set>
+#include<string>
+#include<vector>
+
+//define static variables
+
+//target used by OutFiles which are not given one
+OutputTarget *OutputTarget::default_target = nullptr;
+
+//paths of files which could not be written
+std::set<std::string> OutputTarget::failed_paths;
+
+//guards failed_paths
+std::mutex OutputTarget::failed_lock;
+
+OutputTarget::~OutputTarget() {}
+
+void OutputTarget::create_directory(const std::string &) {}
+
+bool OutputTarget::link(const std::string &, const std::string &) {
+
+    return false;
+}
+
+void OutputTarget::set_default(OutputTarget *target) {
+
+    default_target = target;
+}
+
+OutputTarget &OutputTarget::get_default() {
+
+    //write to the file system if no target has been set
+    if (default_target == nullptr) {
+
+        static DirectoryTarget directory_target;
+
+        default_target = &directory_target;
+    }
+
+    return *default_target;
+}
+
+void OutputTarget::record_failure(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(failed_lock);
+
+    failed_paths.insert(path);
+}
+
+bool OutputTarget::has_failed(const std::string &prefix) {
+
+    std::lock_guard<std::mutex> guard(failed_lock);
+
+    //paths beginning with prefix are sorted directly after it
+    std::set<std::string>::iterator it = failed_paths.lower_bound(prefix);
+
+    return it != failed_paths.end() && it->compare(0, prefix.size(), prefix) == 0;
+}
+
+DirectoryTarget::~DirectoryTarget() {
+
+    //close any files that were left open
+    for (std::map<int, OpenFile>::iterator it = files.begin(); it != files.end(); it++) {
+
+        if (it->second.file != nullptr) {
+
+            std::fclose(it->second.file);
+        }
+    }
+}
+
+int DirectoryTarget::open(const std::string &path) {
+
+    //remove any existing file first, so that rewriting a hard linked file does not change the files linked to it
+    std::error_code error;
+
+    std::filesystem::remove(path, error);
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+
+    if (file == nullptr) {
+
+        std::cout << "Error, could not open " << path << " for writing\n";
+
+        record_failure(path);
+
+    } else {
+
+        //OutFile already buffers, so data is passed straight to the operating system
+        std::setvbuf(file, nullptr, _IONBF, 0);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    files[next_id] = {file, path, file == nullptr};
+    next_id += 1;
+
+    return next_id - 1;
+}
+
+void DirectoryTarget::write(int id, const char *data, size_t size) {
+
+    OpenFile *open_file;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        open_file = &files[id];
+    }
+
+    //only the thread writing a file uses its entry, and map entries do not move when others are added
+    if (open_file->file == nullptr || open_file->failed) return;
+
+    if (std::fwrite(data, 1, size, open_file->file) != size) {
+
+        std::cout << "Error, could not write to " << open_file->path << "\n";
+
+        record_failure(open_file->path);
+
+        open_file->failed = true;
+    }
+}
+
+bool DirectoryTarget::close(int id) {
+
+    OpenFile open_file;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        open_file = files[id];
+        files.erase(id);
+    }
+
+    if (open_file.file == nullptr) return false;
+
+    //closing can also fail, such as when a network file system is full
+    if (std::fclose(open_file.file) != 0 && !open_file.failed) {
+
+        std::cout << "Error, could not write to " << open_file.path << "\n";
+
+        record_failure(open_file.path);
+
+        open_file.failed = true;
+    }
+
+    return !open_file.failed;
+}
+
+bool DirectoryTarget::exists(const std::string &path) {
+
+    return std::filesystem::exists(path);
+}
+
+void DirectoryTarget::create_directory(const std::string &path) {
+
+    //fails if a file is in the way, which is reported when the files inside the directory cannot be opened
+    std::error_code error;
+
+    std::filesystem::create_directory(path, error);
+}
+
+bool DirectoryTarget::link(const std::string &existing_path, const std::string &path) {
+
+    //fails if the file system does not support hard links
+    std::error_code error;
+
+    //replace files from earlier runs
+    std::filesystem::remove(path, error);
+
+    std::filesystem::create_hard_link(existing_path, path, error);
+
+    return !error;
+}
+
+int MemoryTarget::open(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    files[path].clear();
+
+    open_paths[next_id] = path;
+    next_id += 1;
+
+    return next_id - 1;
+}
+
+void MemoryTarget::write(int id, const char *data, size_t size) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<char> &file = files[open_paths[id]];
+
+    file.insert(file.end(), data, data + size);
+}
+
+bool MemoryTarget::close(int id) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    open_paths.erase(id);
+
+    return true;
+}
+
+bool MemoryTarget::exists(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    return files.count(path) > 0;
+}
+
+bool MemoryTarget::link(const std::string &existing_path, const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (files.count(existing_path) == 0) return false;
+
+    files[path] = files[existing_path];
+
+    return true;
+}
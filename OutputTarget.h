@@ -0,0 +1,134 @@
+#include<cstdio>
+#include<map>
+#include<mutex>
+#include<set>
+#include<string>
+#include<vector>
+
+#ifndef OUTPUTTARGET_H
+#define OUTPUTTARGET_H
+
+//destination for files produced by the ripper
+//files are written through OutFile, which collects data in large buffers before passing it on
+class OutputTarget {
+
+public:
+
+    virtual ~OutputTarget();
+
+    //begins a new file at path, returns an id used to write to and close the file
+    virtual int open(const std::string &path) = 0;
+
+    //appends data to an open file
+    virtual void write(int id, const char *data, size_t size) = 0;
+
+    //finishes writing a file
+    //returns false if the file could not be written, targets which write files later report failures with record_failure instead
+    virtual bool close(int id) = 0;
+
+    //returns true if a file already exists at path
+    virtual bool exists(const std::string &path) = 0;
+
+    //creates a directory, if the target uses directories
+    virtual void create_directory(const std::string &path);
+
+    //makes path refer to the same data as the finished file at existing_path, without writing it again
+    //returns false if the target cannot do this, in which case the file must be written normally
+    virtual bool link(const std::string &existing_path, const std::string &path);
+
+    //sets the target used by OutFiles which are not given one
+    static void set_default(OutputTarget *target);
+
+    //returns the target used by OutFiles which are not given one
+    static OutputTarget &get_default();
+
+    //records that the file at path could not be written
+    //called by the target which writes the file, so failures are recorded even when files are written by background threads
+    static void record_failure(const std::string &path);
+
+    //returns true if any file whose path begins with prefix could not be written
+    static bool has_failed(const std::string &prefix = "");
+
+private:
+
+    //target used by OutFiles which are not given one
+    static OutputTarget *default_target;
+
+    //paths of files which could not be written
+    static std::set<std::string> failed_paths;
+
+    //guards failed_paths
+    static std::mutex failed_lock;
+};
+
+//writes files to the file system, relative to the working directory
+//files may be written from multiple threads
+class DirectoryTarget : public OutputTarget {
+
+public:
+
+    ~DirectoryTarget();
+
+    int open(const std::string &path);
+    void write(int id, const char *data, size_t size);
+    bool close(int id);
+    bool exists(const std::string &path);
+    void create_directory(const std::string &path);
+
+    //creates a hard link
+    bool link(const std::string &existing_path, const std::string &path);
+
+private:
+
+    //file opened on the file system
+    struct OpenFile {
+
+        //nullptr if the file could not be opened
+        std::FILE *file;
+
+        std::string path;
+
+        //true once opening or writing has failed
+        bool failed;
+    };
+
+    //open files by id
+    std::map<int, OpenFile> files;
+
+    //id given to the next opened file
+    int next_id = 0;
+
+    //guards files and next_id
+    std::mutex lock;
+};
+
+//keeps files in memory
+//files may be written from multiple threads
+class MemoryTarget : public OutputTarget {
+
+public:
+
+    int open(const std::string &path);
+    void write(int id, const char *data, size_t size);
+    bool close(int id);
+    bool exists(const std::string &path);
+
+    //copies the contents of existing_path
+    bool link(const std::string &existing_path, const std::string &path);
+
+    //contents of each file by path
+    std::map<std::string, std::vector<char>> files;
+
+private:
+
+    //paths of open files by id
+    std::map<int, std::string> open_paths;
+
+    //id given to the next opened file
+    int next_id = 0;
+
+    //guards files, open_paths and next_id
+    std::mutex lock;
+};
+
+#endif
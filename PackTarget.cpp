@@ -0,0 +1,305 @@
+#include "PackTarget.h"
+#include<cstdio>
+#include<cstring>
+#include<filesystem>
+#include<iostream>
+#include<map>
+#include<mutex>
+#include<string>
+#include<vector>
+
+//appends the bytes of value to data
+template <typename T>
+void pack_append(std::vector<char> &data, T value) {
+
+    const char *bytes = reinterpret_cast<const char *>(&value);
+
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+//reads a value from data at offset
+template <typename T>
+T pack_read(const char *data) {
+
+    T value;
+
+    std::memcpy(&value, data, sizeof(T));
+
+    return value;
+}
+
+//moves to offset in file, which may be beyond the range of long on some platforms
+bool pack_seek(std::FILE *file, unsigned long long offset) {
+
+    #ifdef _WIN32
+
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+
+    #else
+
+    return fseeko(file, offset, SEEK_SET) == 0;
+
+    #endif
+}
+
+PackTarget::PackTarget(std::string pack_path):pack_path(pack_path) {
+
+    pack = std::fopen(pack_path.c_str(), "wb");
+
+    if (pack == nullptr) {
+
+        std::cout << "Error, could not open " << pack_path << " for writing\n";
+
+        return;
+    }
+
+    //write header
+    std::vector<char> header;
+
+    const char identifier[4] = {'D', 'P', 'K', '1'};
+
+    header.insert(header.end(), identifier, identifier + 4);
+    pack_append<unsigned int>(header, 1);
+
+    if (!append(header.data(), header.size())) {
+
+        std::cout << "Error, could not write " << pack_path << "\n";
+
+        record_failure(pack_path);
+    }
+}
+
+PackTarget::~PackTarget() {
+
+    finish();
+}
+
+int PackTarget::open(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    open_paths[next_id] = path;
+    open_data[next_id].clear();
+
+    next_id += 1;
+
+    return next_id - 1;
+}
+
+void PackTarget::write(int id, const char *data, size_t size) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<char> &file_data = open_data[id];
+
+    file_data.insert(file_data.end(), data, data + size);
+}
+
+bool PackTarget::close(int id) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::string &path = open_paths[id];
+    std::vector<char> &file_data = open_data[id];
+
+    //add path to directory, replacing any earlier copy
+    if (entry_indices.count(path) == 0) {
+
+        entry_indices[path] = entries.size();
+        entries.push_back(PackEntry());
+        entries.back().path = path;
+    }
+
+    PackEntry &entry = entries[entry_indices[path]];
+
+    entry.offset = pack_size;
+    entry.size = file_data.size();
+
+    bool written = append(file_data.data(), file_data.size());
+
+    if (!written) {
+
+        std::cout << "Error, could not write " << path << " to " << pack_path << "\n";
+
+        record_failure(path);
+    }
+
+    open_paths.erase(id);
+    open_data.erase(id);
+
+    return written;
+}
+
+bool PackTarget::exists(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (entry_indices.count(path) > 0) return true;
+
+    //files which are still open will exist once closed
+    for (std::map<int, std::string>::iterator it = open_paths.begin(); it != open_paths.end(); it++) {
+
+        if (it->second == path) return true;
+    }
+
+    return false;
+}
+
+bool PackTarget::link(const std::string &existing_path, const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (entry_indices.count(existing_path) == 0) return false;
+
+    PackEntry existing_entry = entries[entry_indices[existing_path]];
+
+    if (entry_indices.count(path) == 0) {
+
+        entry_indices[path] = entries.size();
+        entries.push_back(PackEntry());
+    }
+
+    PackEntry &entry = entries[entry_indices[path]];
+
+    entry.path = path;
+    entry.offset = existing_entry.offset;
+    entry.size = existing_entry.size;
+
+    return true;
+}
+
+bool PackTarget::is_open() {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    return pack != nullptr;
+}
+
+void PackTarget::finish() {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (pack == nullptr) return;
+
+    //directory and trailer
+    std::vector<char> directory;
+
+    for (int i = 0; i < entries.size(); i++) {
+
+        pack_append<unsigned long long>(directory, entries[i].offset);
+        pack_append<unsigned long long>(directory, entries[i].size);
+        pack_append<unsigned int>(directory, entries[i].path.size());
+
+        directory.insert(directory.end(), entries[i].path.begin(), entries[i].path.end());
+    }
+
+    const char identifier[4] = {'D', 'P', 'K', '1'};
+
+    pack_append<unsigned long long>(directory, pack_size);
+    pack_append<unsigned int>(directory, entries.size());
+
+    directory.insert(directory.end(), identifier, identifier + 4);
+
+    bool written = append(directory.data(), directory.size());
+
+    //closing can also fail, such as when a network file system is full
+    if (std::fclose(pack) != 0 || !written) {
+
+        std::cout << "Error, could not write directory of " << pack_path << "\n";
+
+        record_failure(pack_path);
+    }
+
+    pack = nullptr;
+}
+
+bool PackTarget::append(const char *data, size_t size) {
+
+    if (pack == nullptr) return false;
+
+    pack_size += size;
+
+    return std::fwrite(data, 1, size, pack) == size;
+}
+
+PackReader::~PackReader() {
+
+    if (pack != nullptr) {
+
+        std::fclose(pack);
+    }
+}
+
+bool PackReader::open(std::string pack_path) {
+
+    if (pack != nullptr) {
+
+        std::fclose(pack);
+    }
+
+    entries.clear();
+
+    std::error_code error;
+
+    unsigned long long pack_size = std::filesystem::file_size(pack_path, error);
+
+    pack = std::fopen(pack_path.c_str(), "rb");
+
+    if (pack == nullptr || error || pack_size < 24) return false;
+
+    //read trailer
+    char trailer[16];
+
+    if (!pack_seek(pack, pack_size - 16) || std::fread(trailer, 1, 16, pack) != 16 || std::memcmp(trailer + 12, "DPK1", 4) != 0) return false;
+
+    unsigned long long directory_offset = pack_read<unsigned long long>(trailer);
+    unsigned int n_entries = pack_read<unsigned int>(trailer + 8);
+
+    if (directory_offset > pack_size - 16) return false;
+
+    //read directory
+    std::vector<char> directory(pack_size - 16 - directory_offset);
+
+    if (!pack_seek(pack, directory_offset) || std::fread(directory.data(), 1, directory.size(), pack) != directory.size()) return false;
+
+    //position in directory
+    size_t position = 0;
+
+    for (int i = 0; i < n_entries; i++) {
+
+        if (position + 20 > directory.size()) return false;
+
+        PackEntry entry;
+
+        entry.offset = pack_read<unsigned long long>(directory.data() + position);
+        entry.size = pack_read<unsigned long long>(directory.data() + position + 8);
+
+        unsigned int path_length = pack_read<unsigned int>(directory.data() + position + 16);
+
+        position += 20;
+
+        if (position + path_length > directory.size() || entry.offset > directory_offset || entry.size > directory_offset - entry.offset) return false;
+
+        entry.path.assign(directory.data() + position, path_length);
+
+        position += path_length;
+
+        entries.push_back(entry);
+    }
+
+    return true;
+}
+
+const std::vector<PackEntry> &PackReader::list() {
+
+    return entries;
+}
+
+bool PackReader::read(const PackEntry &entry, std::vector<char> &data) {
+
+    data.resize(entry.size);
+
+    if (pack == nullptr || !pack_seek(pack, entry.offset)) return false;
+
+    return std::fread(data.data(), 1, data.size(), pack) == data.size();
+}
@@ -0,0 +1,130 @@
+#include<cstdio>
+#include<map>
+#include<mutex>
+#include<string>
+#include<vector>
+#include "OutputTarget.h"
+
+#ifndef PACKTARGET_H
+#define PACKTARGET_H
+
+//pack file holding every output file, so a run creates a single file instead of a directory tree
+//
+//all values are little endian
+//0x00  char[4]  identifier "DPK1"
+//0x04  uint32   version, currently 1
+//then  data of each file, appended as files are closed
+//then  directory, for each file:
+//      uint64   offset of data from start of pack
+//      uint64   size of data
+//      uint32   length of path
+//      char[]   path, using / between directories
+//then  trailer:
+//      uint64   offset of directory from start of pack
+//      uint32   number of files in directory
+//      char[4]  identifier "DPK1"
+//
+//files are only ever appended, and the directory is found from the trailer at the end of the pack
+//if a path is written more than once, the directory only lists the last copy
+//identical files may share the same data
+
+//entry in the directory of a pack file
+struct PackEntry {
+
+    //path of file
+    std::string path;
+
+    //offset of data from start of pack
+    unsigned long long offset;
+
+    //size of data
+    unsigned long long size;
+};
+
+//writes files to a single pack file
+//files may be written from multiple threads
+class PackTarget : public OutputTarget {
+
+public:
+
+    //creates the pack file at pack_path
+    PackTarget(std::string pack_path);
+
+    //writes the directory if finish has not been called
+    ~PackTarget();
+
+    int open(const std::string &path);
+    void write(int id, const char *data, size_t size);
+    bool close(int id);
+    bool exists(const std::string &path);
+
+    //adds a directory entry for path which shares the data of existing_path
+    bool link(const std::string &existing_path, const std::string &path);
+
+    //returns false if the pack file could not be created or has been finished
+    bool is_open();
+
+    //writes the directory and trailer, and closes the pack file
+    //no files can be written afterwards
+    void finish();
+
+private:
+
+    //path of pack file
+    std::string pack_path;
+
+    //pack file, nullptr if it could not be created or is finished
+    std::FILE *pack = nullptr;
+
+    //number of bytes written to pack
+    unsigned long long pack_size = 0;
+
+    //paths and data of files which have been opened but not closed, by id
+    std::map<int, std::string> open_paths;
+    std::map<int, std::vector<char>> open_data;
+
+    //directory entries in the order files were first written
+    std::vector<PackEntry> entries;
+
+    //index of each path in entries
+    std::map<std::string, int> entry_indices;
+
+    //id given to the next opened file
+    int next_id = 0;
+
+    //guards all variables above
+    std::mutex lock;
+
+    //writes data to the end of the pack
+    //returns false if the data could not be written
+    bool append(const char *data, size_t size);
+};
+
+//reads the directory and files of a pack file
+class PackReader {
+
+public:
+
+    ~PackReader();
+
+    //opens the pack file at pack_path and reads its directory
+    //returns false if the file cannot be read or is not a finished pack
+    bool open(std::string pack_path);
+
+    //returns the directory of the pack
+    const std::vector<PackEntry> &list();
+
+    //reads the data of entry into data
+    //returns false if the data cannot be read
+    bool read(const PackEntry &entry, std::vector<char> &data);
+
+private:
+
+    //open pack file
+    std::FILE *pack = nullptr;
+
+    //directory of pack
+    std::vector<PackEntry> entries;
+};
+
+#endif
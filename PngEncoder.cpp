@@ -0,0 +1,161 @@
+#include "PngEncoder.h"
+#include "Deflate.h"
+#include<cstddef>
+#include<vector>
+
+void PngEncoder::encode(int width, int height, int colour_type, int bit_depth, const std::vector<unsigned char> &rows, std::vector<char> &png, bool compress) {
+
+    append_header(png, width, height, colour_type, bit_depth);
+    append_image_data(png, height, rows, compress);
+}
+
+void PngEncoder::encode_indexed(int width, int height, const std::vector<unsigned char> &rows, const std::vector<unsigned char> &palette, std::vector<char> &png, bool compress) {
+
+    append_header(png, width, height, PALETTE, 8);
+
+    //number of colours in palette
+    int n_colours = palette.size()/4;
+
+    //palette chunk holds red, green, and blue of each colour
+    std::vector<char> colours;
+
+    //transparency chunk holds alpha of each colour, and can stop after the last colour which is not fully opaque
+    std::vector<char> alphas;
+
+    for (int i = 0; i < n_colours; i++) {
+
+        colours.push_back(palette[4*i]);
+        colours.push_back(palette[4*i + 1]);
+        colours.push_back(palette[4*i + 2]);
+
+        alphas.push_back(palette[4*i + 3]);
+    }
+
+    while (!alphas.empty() && static_cast<unsigned char>(alphas.back()) == 0xFF) {
+
+        alphas.pop_back();
+    }
+
+    append_chunk(png, "PLTE", colours);
+
+    if (!alphas.empty()) {
+
+        append_chunk(png, "tRNS", alphas);
+    }
+
+    append_image_data(png, height, rows, compress);
+}
+
+void PngEncoder::append_header(std::vector<char> &png, int width, int height, int colour_type, int bit_depth) {
+
+    //png signature
+    const char signature[8] = {-119, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    png.insert(png.end(), signature, signature + 8);
+
+    //header chunk
+    std::vector<char> header;
+
+    append_big_endian(header, width);
+    append_big_endian(header, height);
+    header.push_back(bit_depth);
+    header.push_back(colour_type);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+
+    append_chunk(png, "IHDR", header);
+}
+
+void PngEncoder::append_image_data(std::vector<char> &png, int height, const std::vector<unsigned char> &rows, bool compress) {
+
+    //number of bytes in each row
+    size_t row_size = rows.size()/height;
+
+    //raw scanlines, each starting with filter type 0
+    std::vector<char> scanlines;
+
+    scanlines.reserve(height*(row_size + 1));
+
+    for (int i = 0; i < height; i++) {
+
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rows.begin() + i*row_size, rows.begin() + (i + 1)*row_size);
+    }
+
+    //zlib stream
+    std::vector<char> image_data;
+
+    image_data.push_back(0x78);
+    image_data.push_back(compress ? 0x5E : 0x01);
+
+    //adler32 checksum of scanlines
+    unsigned int adler_a = 1;
+    unsigned int adler_b = 0;
+
+    for (size_t i = 0; i < scanlines.size(); i++) {
+
+        adler_a = (adler_a + static_cast<unsigned char>(scanlines[i]))%65521;
+        adler_b = (adler_b + adler_a)%65521;
+    }
+
+    if (compress) {
+
+        Deflate::compress(scanlines.data(), scanlines.size(), 0, true, image_data);
+
+    } else {
+
+        //stored blocks hold at most 65535 bytes
+        size_t position = 0;
+
+        do {
+
+            size_t block_size = scanlines.size() - position;
+
+            if (block_size > 65535) {
+
+                block_size = 65535;
+            }
+
+            //final block flag
+            image_data.push_back(position + block_size == scanlines.size() ? 1 : 0);
+
+            //block length and its complement
+            image_data.push_back(block_size & 0xFF);
+            image_data.push_back((block_size >> 8) & 0xFF);
+            image_data.push_back(~block_size & 0xFF);
+            image_data.push_back((~block_size >> 8) & 0xFF);
+
+            image_data.insert(image_data.end(), scanlines.begin() + position, scanlines.begin() + position + block_size);
+
+            position += block_size;
+
+        } while (position < scanlines.size());
+    }
+
+    append_big_endian(image_data, (adler_b << 16) | adler_a);
+
+    append_chunk(png, "IDAT", image_data);
+    append_chunk(png, "IEND", std::vector<char>());
+}
+
+void PngEncoder::append_big_endian(std::vector<char> &data, unsigned int value) {
+
+    data.push_back((value >> 24) & 0xFF);
+    data.push_back((value >> 16) & 0xFF);
+    data.push_back((value >> 8) & 0xFF);
+    data.push_back(value & 0xFF);
+}
+
+void PngEncoder::append_chunk(std::vector<char> &png, const char *type, const std::vector<char> &chunk_data) {
+
+    append_big_endian(png, chunk_data.size());
+
+    //crc covers chunk type and data
+    size_t crc_start = png.size();
+
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), chunk_data.begin(), chunk_data.end());
+
+    append_big_endian(png, Deflate::crc32(0, png.data() + crc_start, png.size() - crc_start));
+}
@@ -0,0 +1,41 @@
+#include<vector>
+
+#ifndef PNGENCODER_H
+#define PNGENCODER_H
+
+//writes images in .png format
+class PngEncoder {
+
+public:
+
+    //png colour types
+    static const int RGB = 2;
+    static const int PALETTE = 3;
+    static const int RGBA = 6;
+
+    //encodes an image and appends the .png file to png
+    //rows holds the samples of each row from top to bottom, with 16 bit samples stored big endian
+    //image data is compressed with Deflate if compress is true, and stored without compression otherwise
+    static void encode(int width, int height, int colour_type, int bit_depth, const std::vector<unsigned char> &rows, std::vector<char> &png, bool compress = false);
+
+    //encodes an 8 bit palette indexed image and appends the .png file to png
+    //rows holds one palette index for each pixel, from the top row to the bottom row
+    //palette holds the red, green, blue, and alpha values of up to 256 colours
+    static void encode_indexed(int width, int height, const std::vector<unsigned char> &rows, const std::vector<unsigned char> &palette, std::vector<char> &png, bool compress = false);
+
+private:
+
+    //appends the signature and header chunk to png
+    static void append_header(std::vector<char> &png, int width, int height, int colour_type, int bit_depth);
+
+    //appends the image data chunk holding rows, filtered with filter type 0, followed by the end chunk
+    static void append_image_data(std::vector<char> &png, int height, const std::vector<unsigned char> &rows, bool compress);
+
+    //appends a 4 byte big endian value to data
+    static void append_big_endian(std::vector<char> &data, unsigned int value);
+
+    //appends a chunk with the given type to png, followed by its crc
+    static void append_chunk(std::vector<char> &png, const char *type, const std::vector<char> &chunk_data);
+};
+
+#endif
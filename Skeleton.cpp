@@ -204,6 +204,19 @@ void Skeleton::get_animations(char *buf, int animation_offset) {
     //parent joint order
     int parent_order;
 
+    //record where this clip sits in the combined animation
+    //clips are separated by a 60 frame gap, matching Joint::add_animation
+    if (root->animation_frames.size() == 0) {
+
+        clip_starts.push_back(0);
+
+    } else {
+
+        clip_starts.push_back(root->animation_frames.back() + 60);
+    }
+
+    clip_lengths.push_back(subheader->n_frames);
+
     //pointer to joint for which animations are currently being read
     Joint *curr_joint;
 
@@ -298,19 +311,24 @@ void Skeleton::set_frame(int frame) {
     root->set_animation_frame(frame);
 }
 
-std::string Skeleton::pose_array_collada() {
+void Skeleton::set_bind_pose() {
+
+    root->update_tree();
+}
+
+void Skeleton::pose_array_collada(TextBuffer &out) {
 
-    return root->pose_collada();
+    root->pose_collada(out);
 }
 
-std::string Skeleton::collada(int depth) {
+void Skeleton::collada(TextBuffer &out, int depth) {
 
-    return root->collada(depth, 1);
+    root->collada(out, depth, 1);
 }
 
-std::string Skeleton::animation_collada() {
+void Skeleton::animation_collada(TextBuffer &out) {
 
-    return root->animation_collada();
+    root->animation_collada(out);
 }
 
 bool Skeleton::initialised() {
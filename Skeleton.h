@@ -1,6 +1,7 @@
 #include <vector>
 #include <string>
 #include "Joint.h"
+#include "TextBuffer.h"
 
 #ifndef SKELETON_H
 #define SKELETON_H
@@ -34,14 +35,17 @@ public:
     //set skeleton to specifie frame in animation
     void set_frame(int frame);
 
-    //output string of inverse matrices for skeleton
-    std::string pose_array_collada();
+    //return skeleton to its bind pose after set_frame has been used
+    void set_bind_pose();
 
-    //output collada xml for skeleton hierarchy
-    std::string collada(int depth);
+    //write inverse matrices for skeleton to out
+    void pose_array_collada(TextBuffer &out);
 
-    //output collada xml for joint animations
-    std::string animation_collada();
+    //write collada xml for skeleton hierarchy to out
+    void collada(TextBuffer &out, int depth);
+
+    //write collada xml for joint animations to out
+    void animation_collada(TextBuffer &out);
 
     //check if skeleton has been initialised
     bool initialised();
@@ -52,6 +56,12 @@ public:
     //vector of joint IDs
     std::vector<unsigned short int> joint_ids;
 
+    //first frame of each animation clip in the combined animation
+    std::vector<int> clip_starts;
+
+    //number of frames in each animation clip
+    std::vector<int> clip_lengths;
+
     //root node of skeleton tree
     Joint *root = nullptr;
 
@@ -0,0 +1,261 @@
+#include "TarTarget.h"
+#include<algorithm>
+#include<cstdio>
+#include<cstring>
+#include<ctime>
+#include<iostream>
+#include<map>
+#include<mutex>
+#include<set>
+#include<string>
+#include<vector>
+
+//writes value as a zero padded octal number filling width - 1 characters, followed by a null character
+void write_octal(char *field, int width, unsigned long long value) {
+
+    for (int i = width - 2; i >= 0; i--) {
+
+        field[i] = '0' + (value & 7);
+        value >>= 3;
+    }
+
+    field[width - 1] = '\0';
+}
+
+TarTarget::TarTarget(std::FILE *out):out(out) {
+
+    mtime = std::time(nullptr);
+}
+
+TarTarget::~TarTarget() {
+
+    finish();
+}
+
+int TarTarget::open(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    open_paths[next_id] = path;
+    open_data[next_id].clear();
+
+    next_id += 1;
+
+    return next_id - 1;
+}
+
+void TarTarget::write(int id, const char *data, size_t size) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<char> &file_data = open_data[id];
+
+    file_data.insert(file_data.end(), data, data + size);
+}
+
+bool TarTarget::close(int id) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<char> &file_data = open_data[id];
+
+    bool written = write_entry(open_paths[id], '0', file_data.data(), file_data.size());
+
+    if (written) {
+
+        written_paths.insert(open_paths[id]);
+
+    } else {
+
+        std::cout << "Error, could not write " << open_paths[id] << " to tar stream\n";
+
+        record_failure(open_paths[id]);
+    }
+
+    open_paths.erase(id);
+    open_data.erase(id);
+
+    return written;
+}
+
+bool TarTarget::exists(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (written_paths.count(path) > 0) return true;
+
+    //files which are still open will exist once closed
+    for (std::map<int, std::string>::iterator it = open_paths.begin(); it != open_paths.end(); it++) {
+
+        if (it->second == path) return true;
+    }
+
+    return false;
+}
+
+void TarTarget::create_directory(const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    //directory entries end with a slash
+    if (written_paths.insert(path + "/").second) {
+
+        if (!write_entry(path + "/", '5', nullptr, 0)) {
+
+            std::cout << "Error, could not write " << path << " to tar stream\n";
+
+            record_failure(path + "/");
+        }
+    }
+}
+
+bool TarTarget::link(const std::string &existing_path, const std::string &path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (out == nullptr || written_paths.count(existing_path) == 0 || existing_path.size() > 100) return false;
+
+    char header[512];
+
+    if (!fill_header(header, path, '1', 0, existing_path)) return false;
+
+    //a failed link entry may be partly written, so the file cannot be written normally either
+    if (std::fwrite(header, 1, 512, out) != 512) {
+
+        std::cout << "Error, could not write " << path << " to tar stream\n";
+
+        record_failure(path);
+    }
+
+    written_paths.insert(path);
+
+    return true;
+}
+
+void TarTarget::finish() {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (out == nullptr) return;
+
+    //archive ends with two empty blocks
+    char end_blocks[1024] = {};
+
+    if (std::fwrite(end_blocks, 1, 1024, out) != 1024 || std::fflush(out) != 0) {
+
+        std::cout << "Error, could not write end of tar stream\n";
+
+        record_failure("");
+    }
+
+    out = nullptr;
+}
+
+bool TarTarget::write_entry(const std::string &path, char type, const char *data, size_t size) {
+
+    if (out == nullptr) return false;
+
+    //false once any write has failed
+    bool written = true;
+
+    char header[512];
+
+    //store long paths in a pax extended header, which applies to the next entry
+    if (!fill_header(header, path, type, size)) {
+
+        //record is "length path=value\n", where length includes its own digits
+        std::string record = " path=" + path + "\n";
+        std::string length = std::to_string(record.size() + std::to_string(record.size()).size());
+
+        //adding the length can add another digit
+        length = std::to_string(record.size() + length.size());
+
+        record = length + record;
+
+        //pax header is named after the file, shortened to fit the name field
+        fill_header(header, "PaxHeader/" + path.substr(path.size() - 80), 'x', record.size());
+
+        written = written && std::fwrite(header, 1, 512, out) == 512;
+
+        record.resize((record.size() + 511)/512*512, '\0');
+
+        written = written && std::fwrite(record.data(), 1, record.size(), out) == record.size();
+
+        //ustar fields hold the end of the path, which readers without pax support will use
+        fill_header(header, path.substr(path.size() - 100), type, size);
+    }
+
+    written = written && std::fwrite(header, 1, 512, out) == 512;
+
+    if (size > 0) {
+
+        written = written && std::fwrite(data, 1, size, out) == size;
+
+        //pad data to a whole number of blocks
+        char padding[512] = {};
+
+        written = written && std::fwrite(padding, 1, (512 - size%512)%512, out) == (512 - size%512)%512;
+    }
+
+    return written;
+}
+
+bool TarTarget::fill_header(char *header, const std::string &path, char type, size_t size, const std::string &link_path) {
+
+    std::memset(header, 0, 512);
+
+    //path is split between the prefix and name fields at a slash if it is longer than the name field
+    if (path.size() <= 100) {
+
+        std::memcpy(header, path.data(), path.size());
+
+    } else {
+
+        //position of slash to split at
+        size_t split = path.rfind('/', 155);
+
+        //directory paths end with a slash, which must stay in the name field
+        if (split == path.size() - 1 && split > 0) {
+
+            split = path.rfind('/', split - 1);
+        }
+
+        if (split == std::string::npos || path.size() - split - 1 > 100) return false;
+
+        std::memcpy(header + 345, path.data(), split);
+        std::memcpy(header, path.data() + split + 1, path.size() - split - 1);
+    }
+
+    //mode, owner, and group
+    write_octal(header + 100, 8, (type == '5') ? 0755 : 0644);
+    write_octal(header + 108, 8, 0);
+    write_octal(header + 116, 8, 0);
+
+    //size and modification time
+    write_octal(header + 124, 12, size);
+    write_octal(header + 136, 12, mtime);
+
+    header[156] = type;
+
+    std::memcpy(header + 157, link_path.data(), std::min<size_t>(link_path.size(), 100));
+
+    //ustar identifier and version
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+
+    //checksum is calculated with the checksum field filled with spaces
+    std::memset(header + 148, ' ', 8);
+
+    unsigned int checksum = 0;
+
+    for (int i = 0; i < 512; i++) {
+
+        checksum += static_cast<unsigned char>(header[i]);
+    }
+
+    write_octal(header + 148, 7, checksum);
+
+    header[155] = ' ';
+
+    return true;
+}
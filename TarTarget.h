@@ -0,0 +1,69 @@
+#include<cstdio>
+#include<map>
+#include<mutex>
+#include<set>
+#include<string>
+#include<vector>
+#include "OutputTarget.h"
+
+#ifndef TARTARGET_H
+#define TARTARGET_H
+
+//writes files as a POSIX tar stream, such as to stdout for use in a pipeline
+//each file is held in memory until it is closed, then written as a tar entry, so memory use is bounded by the largest open files
+//paths too long for a ustar header are stored using a pax extended header
+//files may be written from multiple threads
+class TarTarget : public OutputTarget {
+
+public:
+
+    //writes the stream to out, which must be opened in binary mode
+    TarTarget(std::FILE *out);
+
+    //writes the end of archive marker if finish has not been called
+    ~TarTarget();
+
+    int open(const std::string &path);
+    void write(int id, const char *data, size_t size);
+    bool close(int id);
+    bool exists(const std::string &path);
+    void create_directory(const std::string &path);
+
+    //writes a hard link entry, if both paths fit in a ustar header
+    bool link(const std::string &existing_path, const std::string &path);
+
+    //writes the end of archive marker and flushes the stream
+    //no files can be written afterwards
+    void finish();
+
+private:
+
+    //stream that the archive is written to, nullptr once finished
+    std::FILE *out;
+
+    //modification time given to every entry
+    long long mtime;
+
+    //paths and data of files which have been opened but not closed, by id
+    std::map<int, std::string> open_paths;
+    std::map<int, std::vector<char>> open_data;
+
+    //paths of files and directories which have been written
+    std::set<std::string> written_paths;
+
+    //id given to the next opened file
+    int next_id = 0;
+
+    //guards all variables above
+    std::mutex lock;
+
+    //writes a header, and pax header if needed, for an entry with the given type flag, followed by its data padded to a multiple of 512 bytes
+    //returns false if the entry could not be written
+    bool write_entry(const std::string &path, char type, const char *data, size_t size);
+
+    //fills a 512 byte ustar header, with link_path as the target of a link entry
+    //returns false if path does not fit in the name and prefix fields
+    bool fill_header(char *header, const std::string &path, char type, size_t size, const std::string &link_path = "");
+};
+
+#endif
@@ -1,7 +1,20 @@
 #include "TexRipper.h"
+#include "Hash.h"
+#include "OutFile.h"
+#include "PngEncoder.h"
+#include "DdsEncoder.h"
+#include<algorithm>
+#include<array>
 #include<iostream>
-#include<fstream>
 #include<string>
+#include<unordered_map>
+#include<vector>
+
+//the avx2 kernel is compiled for any x86 build with gcc or clang, and only used when the cpu supports it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TEXRIPPER_AVX2
+#include<immintrin.h>
+#endif
 
 //texture primary header struct
 struct primary_header {
@@ -108,23 +121,248 @@ void get_palette(char *buffer, int offset, T *palette) {
     }
 }
 
-//define static variables
+//returns map from pixel locations in data to pixel locations in image, for subtextures with standard dimensions
+//evaluated at compile time
+constexpr std::array<int, 8192> generate_map() {
+
+    //map being generated
+    std::array<int, 8192> map = {};
+
+    //offset of top-leftmost pixel in current 32 byte block on the final image
+    int base = 0;
+
+    //counter tracks current byte in block
+    int counter = 0;
+
+    //odd bytes are placed 2 rows below even bytes
+    int skip_line = 0;
+
+    //offset in x direction relative to location in memory
+    int offset = 12;
+
+    //some pixels have an extra offset of -8
+    int bonus_offset = 0;
+
+    for (int i = 0; i < 8192; i++) {
+
+        //set to 256 on odd bytes
+        skip_line = 256*(counter%2);
+
+        //update offset
+        offset += 3;
+
+        //decrease offset every 4 pixels
+        if (counter%4 == 0) {
+
+            offset -= 15;
+        }
+
+        //check for bonus offset
+        if ((counter > 16) && (base%1024 < 512)) {
+
+            bonus_offset = -8*(counter%2);
+        
+        }
+
+        if ((!((counter < 16) && (counter%2 == 0))) && (base%1024 >= 512)) {
+            
+            bonus_offset = -8;
+        }
+
+        //calculate pixel location
+        map[i] = base + counter + skip_line + offset + bonus_offset;
+
+        //update counter
+        counter += 1;
+
+        //reset bonus offset
+        bonus_offset = 0;
+
+        //end of 32 byte block re-initialisation
+        if (counter == 32) {
+
+            //reset variables
+            counter = 0;
+            offset = 12;
+            bonus_offset = 0;
 
-//false if pixel_map has not been initialised
-bool TexRipper::map_init = false;
+            //increase base offset
+            base += 16;
+
+            //skip 2 lines after completing 2 lines
+            if (base%256 == 0) {
+
+                base += 256;
+            }
+
+            //adjust offset on alternating line skips
+            if (base%1024 >= 512) {
+
+                offset = 16;
+            }
+        }
+    }
+
+    return map;
+}
+
+//returns true if map contains every pixel location exactly once
+constexpr bool is_permutation(const std::array<int, 8192> &map) {
+
+    //number of times each location appears
+    std::array<int, 8192> count = {};
+
+    for (int i = 0; i < 8192; i++) {
+
+        if (map[i] < 0 || map[i] >= 8192) return false;
+
+        count[map[i]] += 1;
+    }
+
+    for (int i = 0; i < 8192; i++) {
+
+        if (count[i] != 1) return false;
+    }
+
+    return true;
+}
 
 //maps pixels from location in data to location in image
-int TexRipper::pixel_map[8192];
+constexpr std::array<int, 8192> pixel_map = generate_map();
+
+//checks against values of the map that was previously generated at runtime
+static_assert(is_permutation(pixel_map), "pixel_map must move every pixel to a different location");
+static_assert(pixel_map[0] == 0 && pixel_map[1] == 260 && pixel_map[2] == 8, "pixel_map does not match the PS2 swizzle pattern");
+static_assert(pixel_map[100] == 49 && pixel_map[4096] == 4096 && pixel_map[8191] == 8191, "pixel_map does not match the PS2 swizzle pattern");
 
-int TexRipper::rip(char *buffer, int offset, std::string out_path) {
+//returns map from pixel locations in image to pixel locations in data, the inverse of map
+constexpr std::array<int, 8192> invert_map(const std::array<int, 8192> &map) {
 
-    //check if pixel_map has been initialised
-    //if not, call generate_map()
-    if (!map_init) {
+    //map being generated
+    std::array<int, 8192> inverse = {};
 
-        generate_map();
+    for (int i = 0; i < 8192; i++) {
+
+        inverse[map[i]] = i;
     }
 
+    return inverse;
+}
+
+//maps pixels from location in image to location in data, so that images can be written one row at a time
+constexpr std::array<int, 8192> source_map = invert_map(pixel_map);
+
+//copies the subtexture of 8 bit palette indices at pixel_data to rows of an index image starting at dest
+//rows are stride pixels apart, and only the first width columns and height rows of the subtexture are written
+//standard 128x64 subtextures are jumbled and are read using source_map, while subtextures with nonstandard dimensions of subtex_x by subtex_y are stored in order
+void unswizzle_subtexture(const unsigned char *pixel_data, bool special_subtex, int subtex_x, unsigned char *dest, int stride, int width, int height) {
+
+    for (int y = 0; y < height; y++) {
+
+        //destination row
+        unsigned char *row = dest + y*stride;
+
+        //first column not yet written
+        int x = 0;
+
+        if (special_subtex) {
+
+            //only the first 8192 pixels are stored
+            for (; x < width && y*subtex_x + x < 8192; x++) {
+
+                row[x] = pixel_data[y*subtex_x + x];
+            }
+
+            for (; x < width; x++) {
+
+                row[x] = 0;
+            }
+
+            continue;
+        }
+
+        //locations in data of the pixels in this row
+        const int *sources = source_map.data() + y*128;
+
+        for (; x < width; x++) {
+
+            row[x] = pixel_data[sources[x]];
+        }
+    }
+}
+
+#ifdef TEXRIPPER_AVX2
+//converts palette indices to colours 8 pixels at a time, with one gather per 8 pixels
+//returns the number of pixels converted, which is count rounded down to a multiple of 8
+__attribute__((target("avx2"))) size_t expand_palette_avx2(const unsigned char *indices, const unsigned int *palette, unsigned int *pixels, size_t count) {
+
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+
+        __m256i colour_indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(indices + i)));
+        __m256i colours = _mm256_i32gather_epi32(reinterpret_cast<const int *>(palette), colour_indices, 4);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(pixels + i), colours);
+    }
+
+    return i;
+}
+#endif
+
+//converts count palette indices to colours using palette
+void expand_palette(const unsigned char *indices, const unsigned int *palette, unsigned int *pixels, size_t count) {
+
+    //first pixel not yet converted
+    size_t i = 0;
+
+#ifdef TEXRIPPER_AVX2
+    //checked once, the first time a texture is decoded
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+    if (has_avx2) {
+
+        i = expand_palette_avx2(indices, palette, pixels, count);
+    }
+#endif
+
+    for (; i < count; i++) {
+
+        pixels[i] = palette[indices[i]];
+    }
+}
+
+int TexRipper::rip(char *buffer, int offset, std::string out_path, int format) {
+
+    //decoded texture
+    const TexImage *image = decode(buffer, offset);
+
+    //no texture block at offset
+    if (image == nullptr) {
+
+        return -1;
+    }
+
+    write(*image, out_path, format);
+
+    return reinterpret_cast<primary_header *>(buffer + offset)[0].texture_size;
+}
+
+const TexImage *TexRipper::decode(char *buffer, int offset) {
+
+    //image reused by every call on this thread, so its storage only grows when a larger texture is decoded
+    thread_local TexImage scratch;
+
+    if (decode(buffer, offset, scratch) == -1) {
+
+        return nullptr;
+    }
+
+    return &scratch;
+}
+
+int TexRipper::decode(char *buffer, int offset, TexImage &image) {
+
     //header containing texture info
     primary_header header_1 = reinterpret_cast<primary_header *>(buffer + offset)[0];
 
@@ -135,15 +373,9 @@ int TexRipper::rip(char *buffer, int offset, std::string out_path) {
         return -1;
     }
 
-    //variable size array of 48 byte blocks in header
+    //variable size array of 48 byte blocks in header, read in place from buffer
     //contains offsets to palette and each subtexture
-    secondary_header_block *header_2 = new secondary_header_block[header_1.n_subtextures];
-
-    //obtain header blocks from buffer
-    for (int i = 0; i < header_1.n_subtextures; i++) {
-
-        header_2[i] = reinterpret_cast<secondary_header_block *>(buffer + offset + header_1.secondary_header_offset)[i];
-    }
+    const secondary_header_block *header_2 = reinterpret_cast<secondary_header_block *>(buffer + offset + header_1.secondary_header_offset);
 
     //palette array
     unsigned short int palette[256];
@@ -205,13 +437,6 @@ int TexRipper::rip(char *buffer, int offset, std::string out_path) {
 
     rgba32_palette = true;
 
-    //array of subtexture arrays
-    //all subtextures are 128x64 at most
-    unsigned short int (*subtextures)[8192] = new unsigned short int[header_1.n_subtextures - 1][8192];
-
-    //array of subtexture arrays when using 32 bit palette
-    unsigned int (*subtextures_32)[8192] = new unsigned int[header_1.n_subtextures - 1][8192];
-
     //pointer to pixel data in buffer
     unsigned char *pixel_data;
 
@@ -234,47 +459,168 @@ int TexRipper::rip(char *buffer, int offset, std::string out_path) {
         special_subtex = true;
     }
 
-    //obtain subtextures from buffer
+    //number of subtexture columns in combined texture
+    int tex_cols = std::max(1, header_1.tex_width/subtex_x);
+
+    //set image dimensions
+    image.width = header_1.tex_width;
+    image.height = header_1.tex_height;
+
+    //combined texture arrays
+    //storage is reused if image has held a texture at least as large
+    image.indices.assign(header_1.tex_height*header_1.tex_width, 0);
+    image.pixels.resize(header_1.tex_height*header_1.tex_width);
+    image.palette.assign(palette_32, palette_32 + 256);
+
+    //copy each subtexture straight into its place in the combined texture
+    //pixels are added upside down as .bmp stores images upside down
     for (int i = 0; i < header_1.n_subtextures-1; i++) {
 
         pixel_data = (unsigned char *)(buffer + offset + header_2[i+1].subtex_offset + 96);
 
-        for (int j = 0; j < 8192; j++) {
+        //position of subtexture in combined texture
+        int x = subtex_x*(i%tex_cols);
+        int y = subtex_y*(i/tex_cols);
 
-            //subtextures with standard dimensions are jumbled, and the pixel map must be used to decode them
-            if (!special_subtex) {
+        if (y >= header_1.tex_height) break;
 
-                subtextures_32[i][pixel_map[j]] = palette_32[pixel_data[j]];
-            
-            //subtextures with nonstandard dimensions are stored in the correct order
-            } else {
+        unswizzle_subtexture(pixel_data, special_subtex, subtex_x, image.indices.data() + y*header_1.tex_width + x, header_1.tex_width, std::min(subtex_x, header_1.tex_width - x), std::min(subtex_y, header_1.tex_height - y));
+    }
+
+    expand_palette(image.indices.data(), palette_32, image.pixels.data(), image.pixels.size());
+
+    //return offset to end of texture block
+    return header_1.texture_size;
+}
+
+//converts image to 8 bit palette indices, with rows from top to bottom, and a palette holding the red, green, blue, and alpha values of each colour
+//colours are numbered in the order they first appear
+//returns false if the image has more than 256 colours
+bool index_colours(const TexImage &image, std::vector<unsigned char> &indices, std::vector<unsigned char> &palette) {
+
+    //index of each colour found so far
+    std::unordered_map<unsigned int, int> colour_indices;
+
+    indices.resize(image.width*image.height);
+    palette.clear();
 
-                subtextures_32[i][j] = palette_32[pixel_data[j]];
+    //most neighbouring pixels have the same colour, so the last colour is checked before the map
+    unsigned int last_colour = 0;
+    int last_index = -1;
+
+    for (int i = 0; i < image.height; i++) {
+
+        const unsigned int *row = image.pixels.data() + (image.height - 1 - i)*image.width;
+
+        for (int j = 0; j < image.width; j++) {
+
+            if (row[j] != last_colour || last_index == -1) {
+
+                last_colour = row[j];
+
+                std::unordered_map<unsigned int, int>::iterator it = colour_indices.find(last_colour);
+
+                if (it != colour_indices.end()) {
+
+                    last_index = it->second;
+
+                } else {
+
+                    if (colour_indices.size() == 256) return false;
+
+                    last_index = colour_indices.size();
+                    colour_indices[last_colour] = last_index;
+
+                    palette.push_back((last_colour >> 16) & 0xFF);
+                    palette.push_back((last_colour >> 8) & 0xFF);
+                    palette.push_back(last_colour & 0xFF);
+                    palette.push_back((last_colour >> 24) & 0xFF);
+                }
             }
+
+            indices[i*image.width + j] = last_index;
         }
     }
 
-    //number of subtexture columns in combined texture
-    int tex_cols = header_1.tex_width/subtex_x;
+    return true;
+}
 
-    //combined texture array
-    unsigned short int *combined_tex = new unsigned short int[header_1.tex_height*header_1.tex_width];
+unsigned long long TexRipper::hash(char *buffer, int offset) {
 
-    //combined texture array if using 32 bit palette
-    unsigned int *combined_tex_32 = new unsigned int[header_1.tex_height*header_1.tex_width];
+    primary_header header_1 = reinterpret_cast<primary_header *>(buffer + offset)[0];
 
-    //combine subtextures
-    //pixels are added upside down as .bmp stores images upside down
-    for (int i = 0; i < header_1.tex_height; i++) {
+    if (header_1.identifier != 0x00324852) {
 
-        for (int j = 0; j < header_1.tex_width; j++) {
+        return 0;
+    }
 
-            combined_tex_32[i*header_1.tex_width + j] = subtextures_32[tex_cols*(i/subtex_y) + j/subtex_x][subtex_x*(i%subtex_y) + (j%subtex_x)];
-        }
+    return Hash::hash64(buffer + offset, header_1.texture_size);
+}
+
+//define static variables
+
+//number of threads used to compress each DDS texture
+int TexRipper::n_threads = 1;
+
+//true if DDS textures include a full chain of mipmaps
+bool TexRipper::mipmaps = false;
+
+std::string TexRipper::extension(int format) {
+
+    if (format == PNG || format == PNG8) {
+
+        return "png";
+
+    } else if (format == RAW) {
+
+        return "raw";
+
+    } else if (format == DDS) {
+
+        return "dds";
+    }
+
+    return "bmp";
+}
+
+void TexRipper::write(const TexImage &image, std::string out_path, int format) {
+
+    if (format == PNG) {
+
+        write_png(image, out_path);
+
+    } else if (format == BMP8) {
+
+        write_bmp8(image, out_path);
+
+    } else if (format == PNG8) {
+
+        write_png8(image, out_path);
+
+    } else if (format == DDS) {
+
+        write_dds(image, out_path);
+
+    } else if (format == RAW) {
+
+        OutFile RAW_file(out_path);
+
+        RAW_file.write(reinterpret_cast<const char *>(&image.width), 4);
+        RAW_file.write(reinterpret_cast<const char *>(&image.height), 4);
+        RAW_file.write(reinterpret_cast<const char *>(image.pixels.data()), 4*image.width*image.height);
+
+        RAW_file.close();
+
+    } else {
+
+        write_bmp(image, out_path);
     }
+}
+
+void TexRipper::write_bmp(const TexImage &image, std::string out_path) {
 
     //bmp file
-    std::ofstream OutFile(out_path, std::ios::binary|std::ios::trunc);
+    OutFile BMP(out_path);
 
     //char array for bmp header
     char bmp_header[0x8A] = {0};
@@ -286,7 +632,7 @@ int TexRipper::rip(char *buffer, int offset, std::string out_path) {
     //file size
     int bmp_size;
 
-    bmp_size = 0x8A + 4*header_1.tex_width*header_1.tex_height;
+    bmp_size = 0x8A + 4*image.width*image.height;
 
     bmp_header[2] = bmp_size & 0xFF;
     bmp_header[3] = (bmp_size >> 8) & 0xFF;
@@ -300,12 +646,12 @@ int TexRipper::rip(char *buffer, int offset, std::string out_path) {
     bmp_header[14] = 0x7C;
 
     //image width
-    bmp_header[18] = header_1.tex_width & 0xFF;
-    bmp_header[19] = (header_1.tex_width >> 8) & 0xFF;
+    bmp_header[18] = image.width & 0xFF;
+    bmp_header[19] = (image.width >> 8) & 0xFF;
 
     //image height
-    bmp_header[22] = header_1.tex_height & 0xFF;
-    bmp_header[23] = (header_1.tex_height >> 8) & 0xFF;
+    bmp_header[22] = image.height & 0xFF;
+    bmp_header[23] = (image.height >> 8) & 0xFF;
 
     //planes
     bmp_header[26] = 0x01;
@@ -331,97 +677,207 @@ int TexRipper::rip(char *buffer, int offset, std::string out_path) {
     bmp_header[122] = 0x02;
 
     //write header
-    OutFile.write(bmp_header, 0x8A);
+    BMP.write(bmp_header, 0x8A);
 
     //write pixel data
-    OutFile.write(reinterpret_cast<char *>(combined_tex_32), 4*header_1.tex_width*header_1.tex_height);
+    BMP.write(reinterpret_cast<const char *>(image.pixels.data()), 4*image.width*image.height);
+
+    BMP.close();
+}
 
-    //free resources
-    OutFile.close();
-    delete[] header_2;
-    delete[] subtextures;
-    delete[] subtextures_32;
-    delete[] combined_tex;
-    delete[] combined_tex_32;
+void TexRipper::write_bmp8(const TexImage &image, std::string out_path) {
 
-    //return offset to end of texture block
-    return header_1.texture_size;
+    //bmp file
+    OutFile BMP(out_path);
+
+    //rows are padded to a multiple of 4 bytes
+    int row_size = (image.width + 3)/4*4;
+
+    //offset to pixel data, after the file header, info header, and palette
+    int pixel_offset = 14 + 40 + 4*256;
+
+    //char array for bmp header
+    char bmp_header[14 + 40] = {0};
+
+    //identifier
+    bmp_header[0] = 0x42;
+    bmp_header[1] = 0x4D;
+
+    //file size
+    int bmp_size = pixel_offset + row_size*image.height;
+
+    for (int i = 0; i < 4; i++) {
+
+        bmp_header[2 + i] = (bmp_size >> 8*i) & 0xFF;
+        bmp_header[10 + i] = (pixel_offset >> 8*i) & 0xFF;
+    }
+
+    //header size
+    bmp_header[14] = 40;
+
+    //image width
+    bmp_header[18] = image.width & 0xFF;
+    bmp_header[19] = (image.width >> 8) & 0xFF;
+
+    //image height
+    bmp_header[22] = image.height & 0xFF;
+    bmp_header[23] = (image.height >> 8) & 0xFF;
+
+    //planes
+    bmp_header[26] = 0x01;
+
+    //bits per pixel
+    bmp_header[28] = 0x08;
+
+    //number of palette colours
+    bmp_header[47] = 0x01;
+
+    //write header
+    BMP.write(bmp_header, 14 + 40);
+
+    //palette entries are stored as blue, green, red, alpha, which is the same layout as pixels
+    BMP.write(reinterpret_cast<const char *>(image.palette.data()), 4*256);
+
+    //indices are stored bottom row first, the same as bmp rows
+    char padding[4] = {0};
+
+    for (int i = 0; i < image.height; i++) {
+
+        BMP.write(reinterpret_cast<const char *>(image.indices.data()) + i*image.width, image.width);
+        BMP.write(padding, row_size - image.width);
+    }
+
+    BMP.close();
 }
 
-void TexRipper::generate_map() {
+void TexRipper::write_png(const TexImage &image, std::string out_path) {
 
-    //offset of top-leftmost pixel in current 32 byte block on the final image
-    int base = 0;
+    //encoded file, reused by every call on this thread
+    thread_local std::vector<char> png;
 
-    //counter tracks current byte in block
-    int counter = 0;
+    png.clear();
 
-    //odd bytes are placed 2 rows below even bytes
-    int skip_line = 0;
+    encode_png(image, png);
 
-    //offset in x direction relative to location in memory
-    int offset = 12;
+    OutFile PNG_file(out_path);
 
-    //some pixels have an extra offset of -8
-    int bonus_offset = 0;
+    PNG_file.write(png.data(), png.size());
 
-    for (int i = 0; i < 8192; i++) {
+    PNG_file.close();
+}
 
-        //set to 256 on odd bytes
-        skip_line = 256*(counter%2);
+void TexRipper::write_png8(const TexImage &image, std::string out_path) {
 
-        //update offset
-        offset += 3;
+    //indices and palette, and encoded file, reused by every call on this thread
+    thread_local std::vector<unsigned char> rows;
+    thread_local std::vector<unsigned char> palette;
+    thread_local std::vector<char> png;
 
-        //decrease offset every 4 pixels
-        if (counter%4 == 0) {
+    //png stores the top row first, so rows are read from the end of the index data
+    rows.resize(image.width*image.height);
 
-            offset -= 15;
-        }
+    for (int i = 0; i < image.height; i++) {
 
-        //check for bonus offset
-        if ((counter > 16) && (base%1024 < 512)) {
+        std::copy(image.indices.begin() + (image.height - 1 - i)*image.width, image.indices.begin() + (image.height - i)*image.width, rows.begin() + i*image.width);
+    }
 
-            bonus_offset = -8*(counter%2);
-        
-        }
+    palette.clear();
 
-        if ((!((counter < 16) && (counter%2 == 0))) && (base%1024 >= 512)) {
-            
-            bonus_offset = -8;
-        }
+    for (int i = 0; i < image.palette.size(); i++) {
 
-        //calculate pixel location
-        pixel_map[i] = base + counter + skip_line + offset + bonus_offset;
+        palette.push_back((image.palette[i] >> 16) & 0xFF);
+        palette.push_back((image.palette[i] >> 8) & 0xFF);
+        palette.push_back(image.palette[i] & 0xFF);
+        palette.push_back((image.palette[i] >> 24) & 0xFF);
+    }
 
-        //update counter
-        counter += 1;
+    png.clear();
 
-        //reset bonus offset
-        bonus_offset = 0;
+    PngEncoder::encode_indexed(image.width, image.height, rows, palette, png, true);
 
-        //end of 32 byte block re-initialisation
-        if (counter == 32) {
+    OutFile PNG_file(out_path);
 
-            //reset variables
-            counter = 0;
-            offset = 12;
-            bonus_offset = 0;
+    PNG_file.write(png.data(), png.size());
 
-            //increase base offset
-            base += 16;
+    PNG_file.close();
+}
 
-            //skip 2 lines after completing 2 lines
-            if (base%256 == 0) {
+void TexRipper::write_dds(const TexImage &image, std::string out_path) {
 
-                base += 256;
-            }
+    //pixels and encoded file, reused by every call on this thread
+    thread_local std::vector<unsigned char> rgba;
+    thread_local std::vector<char> dds;
 
-            //adjust offset on alternating line skips
-            if (base%1024 >= 512) {
+    rgba.clear();
+    rgba.reserve(4*image.width*image.height);
 
-                offset = 16;
+    //true if every pixel is either opaque or fully transparent
+    bool binary_alpha = true;
+
+    //dds stores the top row first, so rows are read from the end of the pixel data
+    for (int i = image.height - 1; i >= 0; i--) {
+
+        for (int j = 0; j < image.width; j++) {
+
+            unsigned int pixel = image.pixels[i*image.width + j];
+
+            //ps2 textures use 0x80 for fully opaque pixels
+            unsigned int alpha = pixel >> 24;
+
+            alpha = (alpha >= 0x80) ? 0xFF : 2*alpha;
+
+            if (alpha != 0 && alpha != 0xFF) {
+
+                binary_alpha = false;
             }
+
+            rgba.push_back((pixel >> 16) & 0xFF);
+            rgba.push_back((pixel >> 8) & 0xFF);
+            rgba.push_back(pixel & 0xFF);
+            rgba.push_back(alpha);
         }
     }
-}
\ No newline at end of file
+
+    dds.clear();
+
+    DdsEncoder::encode(image.width, image.height, binary_alpha ? DdsEncoder::BC1 : DdsEncoder::BC3, rgba, dds, n_threads, mipmaps);
+
+    OutFile DDS_file(out_path);
+
+    DDS_file.write(dds.data(), dds.size());
+
+    DDS_file.close();
+}
+
+void TexRipper::encode_png(const TexImage &image, std::vector<char> &png) {
+
+    //png stores the top row first, so rows are read from the end of the pixel data
+    //samples and palette are reused by every call on this thread
+    thread_local std::vector<unsigned char> rows;
+    thread_local std::vector<unsigned char> palette;
+
+    if (index_colours(image, rows, palette)) {
+
+        PngEncoder::encode_indexed(image.width, image.height, rows, palette, png, true);
+
+        return;
+    }
+
+    rows.clear();
+    rows.reserve(4*image.width*image.height);
+
+    for (int i = image.height - 1; i >= 0; i--) {
+
+        for (int j = 0; j < image.width; j++) {
+
+            unsigned int pixel = image.pixels[i*image.width + j];
+
+            rows.push_back((pixel >> 16) & 0xFF);
+            rows.push_back((pixel >> 8) & 0xFF);
+            rows.push_back(pixel & 0xFF);
+            rows.push_back((pixel >> 24) & 0xFF);
+        }
+    }
+
+    PngEncoder::encode(image.width, image.height, PngEncoder::RGBA, 8, rows, png, true);
+}
@@ -1,27 +1,97 @@
 #include<string>
+#include<vector>
 
 #ifndef TEXRIPPER_H
 #define TEXRIPPER_H
 
+//decoded texture image
+//pixels are 0xAARRGGBB values stored bottom row first, the same layout used by .bmp files
+struct TexImage {
+
+    //width of image in pixels
+    int width = 0;
+
+    //height of image in pixels
+    int height = 0;
+
+    //pixel data
+    std::vector<unsigned int> pixels;
+
+    //index into palette of each pixel, in the same order as pixels
+    std::vector<unsigned char> indices;
+
+    //the texture's 256 colour palette, in its original order, with colours in the same format as pixels
+    std::vector<unsigned int> palette;
+};
+
 class TexRipper {
 
 public:
 
-    //rips texture from buffer starting at offset
+    //texture file formats
+    //RAW files hold the width and height as 4 byte integers, followed by the pixels in the same layout as TexImage
+    //BMP8 and PNG8 files hold the palette indices of each pixel and the texture's original palette
+    //DDS files are block compressed, with alpha scaled so that 255 is opaque
+    static const int BMP = 0;
+    static const int PNG = 1;
+    static const int RAW = 2;
+    static const int BMP8 = 3;
+    static const int PNG8 = 4;
+    static const int DDS = 5;
+
+    //number of threads used to compress each DDS texture
+    static int n_threads;
+
+    //true if DDS textures include a full chain of mipmaps
+    static bool mipmaps;
+
+    //rips texture from buffer starting at offset, writing it in format
     //returns offset to end of texture block
     //if buffer does not contain a texture block at offset, then it returns -1 instead
-    static int rip(char *buffer, int offset, std::string output_path);
+    static int rip(char *buffer, int offset, std::string output_path, int format = BMP);
+
+    //decodes texture from buffer starting at offset into image
+    //the pixel storage of image is reused, so decoding into the same image repeatedly does not allocate memory
+    //returns offset to end of texture block
+    //if buffer does not contain a texture block at offset, then it returns -1 instead
+    static int decode(char *buffer, int offset, TexImage &image);
+
+    //decodes texture from buffer starting at offset into an image owned by the calling thread
+    //the image is overwritten by the next call on the same thread, so it must be copied to be kept
+    //if buffer does not contain a texture block at offset, then it returns nullptr instead
+    static const TexImage *decode(char *buffer, int offset);
+
+    //returns a hash of the whole texture block in buffer starting at offset, including its headers, palette, and pixel data
+    //identical blocks always have the same hash, so it can be used to find textures shared between monsters
+    //if buffer does not contain a texture block at offset, then it returns 0 instead
+    static unsigned long long hash(char *buffer, int offset);
+
+    //returns the file extension used for format, without a dot
+    static std::string extension(int format);
+
+    //writes image to a file in format
+    static void write(const TexImage &image, std::string output_path, int format);
+
+    //writes image to a .bmp file
+    static void write_bmp(const TexImage &image, std::string output_path);
+
+    //writes the palette indices and palette of image to an 8 bit .bmp file
+    //alpha values are stored in the unused fourth byte of each palette entry
+    static void write_bmp8(const TexImage &image, std::string output_path);
 
-private:
+    //writes image to a compressed .png file, as in encode_png
+    static void write_png(const TexImage &image, std::string output_path);
 
-    //generates pixel_map array
-    static void generate_map();
+    //writes the palette indices and palette of image to a compressed 8 bit .png file, with alpha values in a tRNS chunk
+    static void write_png8(const TexImage &image, std::string output_path);
 
-    //map from pixel locations in data to pixel locations in image
-    static int pixel_map[8192];
+    //writes image to a block compressed .dds file
+    //textures whose pixels are either opaque or fully transparent use BC1, and other textures use BC3
+    static void write_dds(const TexImage &image, std::string output_path);
 
-    //false if pixel_map has not been initialised
-    static bool map_init;
+    //encodes image as a compressed .png file, appending it to png
+    //images with at most 256 colours are stored as 8 bit palette indices, and other images as 32 bit RGBA
+    static void encode_png(const TexImage &image, std::vector<char> &png);
 };
 
 #endif
\ No newline at end of file
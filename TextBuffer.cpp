@@ -0,0 +1,95 @@
+#include "TextBuffer.h"
+#include "NumberFormat.h"
+#include "OutFile.h"
+#include<cstring>
+#include<string>
+
+TextBuffer::TextBuffer(OutFile &out):out(out) {}
+
+TextBuffer &TextBuffer::operator<<(const char *str) {
+
+    write(str, std::strlen(str));
+
+    return *this;
+}
+
+TextBuffer &TextBuffer::operator<<(const std::string &str) {
+
+    write(str.data(), str.size());
+
+    return *this;
+}
+
+TextBuffer &TextBuffer::operator<<(char c) {
+
+    out.reserve(1)[0] = c;
+    out.commit(1);
+
+    return *this;
+}
+
+TextBuffer &TextBuffer::operator<<(int value) {
+
+    return *this << static_cast<long long>(value);
+}
+
+TextBuffer &TextBuffer::operator<<(unsigned int value) {
+
+    return *this << static_cast<unsigned long long>(value);
+}
+
+TextBuffer &TextBuffer::operator<<(long value) {
+
+    return *this << static_cast<long long>(value);
+}
+
+TextBuffer &TextBuffer::operator<<(unsigned long value) {
+
+    return *this << static_cast<unsigned long long>(value);
+}
+
+TextBuffer &TextBuffer::operator<<(long long value) {
+
+    char *start = out.reserve(NumberFormat::MAX_LENGTH);
+
+    out.commit(NumberFormat::write(start, value) - start);
+
+    return *this;
+}
+
+TextBuffer &TextBuffer::operator<<(unsigned long long value) {
+
+    char *start = out.reserve(NumberFormat::MAX_LENGTH);
+
+    out.commit(NumberFormat::write(start, value) - start);
+
+    return *this;
+}
+
+TextBuffer &TextBuffer::operator<<(double value) {
+
+    char *start = out.reserve(NumberFormat::MAX_LENGTH);
+
+    out.commit(NumberFormat::write(start, value, NumberFormat::GENERAL) - start);
+
+    return *this;
+}
+
+void TextBuffer::write_fixed(double value) {
+
+    char *start = out.reserve(NumberFormat::MAX_LENGTH);
+
+    out.commit(NumberFormat::write(start, value, NumberFormat::FIXED) - start);
+}
+
+void TextBuffer::write_exact(float value) {
+
+    char *start = out.reserve(NumberFormat::MAX_LENGTH);
+
+    out.commit(NumberFormat::write_exact(start, value) - start);
+}
+
+void TextBuffer::write(const char *data, size_t size) {
+
+    out.write(data, size);
+}
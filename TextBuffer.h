@@ -0,0 +1,45 @@
+#include<string>
+#include "OutFile.h"
+
+#ifndef TEXTBUFFER_H
+#define TEXTBUFFER_H
+
+class TextBuffer {
+
+public:
+
+    //creates a text writer which formats text directly into the buffer of out
+    TextBuffer(OutFile &out);
+
+    //append text
+    TextBuffer &operator<<(const char *str);
+    TextBuffer &operator<<(const std::string &str);
+    TextBuffer &operator<<(char c);
+
+    //append integers
+    TextBuffer &operator<<(int value);
+    TextBuffer &operator<<(unsigned int value);
+    TextBuffer &operator<<(long value);
+    TextBuffer &operator<<(unsigned long value);
+    TextBuffer &operator<<(long long value);
+    TextBuffer &operator<<(unsigned long long value);
+
+    //append floating point value using NumberFormat's GENERAL style unless another style is selected
+    TextBuffer &operator<<(double value);
+
+    //append floating point value using NumberFormat's FIXED style unless another style is selected
+    void write_fixed(double value);
+
+    //append single precision value exactly, ignoring the selected style
+    void write_exact(float value);
+
+    //append raw chars
+    void write(const char *data, size_t size);
+
+private:
+
+    //file that text is written to
+    OutFile &out;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "TextureRegistry.h"
+#include<map>
+#include<mutex>
+#include<string>
+
+TextureRegistry::Action TextureRegistry::claim(unsigned long long hash, const std::string &path, std::string &existing_path) {
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::map<std::string, unsigned long long>::iterator it = paths.find(path);
+
+    if (it != paths.end()) {
+
+        if (it->second == hash) return SKIP;
+
+        //path is being overwritten with a different texture, so it can no longer be linked to
+        if (files.count(it->second) > 0 && files[it->second] == path) {
+
+            files.erase(it->second);
+        }
+    }
+
+    paths[path] = hash;
+
+    if (hash != 0) {
+
+        std::map<unsigned long long, std::string>::iterator file = files.find(hash);
+
+        if (file != files.end() && file->second != path) {
+
+            existing_path = file->second;
+
+            return LINK;
+        }
+
+        files[hash] = path;
+    }
+
+    return WRITE;
+}
@@ -0,0 +1,45 @@
+#include<map>
+#include<mutex>
+#include<string>
+
+#ifndef TEXTUREREGISTRY_H
+#define TEXTUREREGISTRY_H
+
+//record of the texture files written during a run, by path and by hash of the texture block
+//used to decide whether a texture needs to be written, linked to an identical file, or skipped, without checking the output target
+//may be used from multiple threads
+class TextureRegistry {
+
+public:
+
+    //what should be done with a texture
+    enum Action {
+
+        //texture must be written to path
+        WRITE,
+
+        //an identical texture has been written, and path can be linked to it
+        LINK,
+
+        //the same texture has already been written to path
+        SKIP
+    };
+
+    //registers that the texture with hash is to be output at path, and returns what should be done with it
+    //for LINK, existing_path is set to the first file written with the same hash
+    //a hash of 0 is never linked, as it is used for blocks which are not textures
+    Action claim(unsigned long long hash, const std::string &path, std::string &existing_path);
+
+private:
+
+    //hash of the texture written to each path
+    std::map<std::string, unsigned long long> paths;
+
+    //path of the first file written for each hash
+    std::map<unsigned long long, std::string> files;
+
+    //guards paths and files
+    std::mutex lock;
+};
+
+#endif
@@ -1,11 +1,176 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
-#include <filesystem>
+#include <vector>
+#include <algorithm>
 #include "MonsterList.h"
 #include "Joint.h"
 #include "Skeleton.h"
 #include "ModelRipper.h"
+#include "NumberFormat.h"
+#include "OutputTarget.h"
+#include "AsyncTarget.h"
+#include "PackTarget.h"
+#include "TarTarget.h"
+#include "GzipTarget.h"
+#include "Manifest.h"
+#include "Hash.h"
+#include "OutFile.h"
+#include <filesystem>
+#include <cstdio>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+//bit flags used to select which outputs are generated for each monster
+const int RIP_TEXTURES = 1;
+const int RIP_DAE = 2;
+const int RIP_OBJ = 4;
+const int RIP_FRAMES = 8;
+const int RIP_GLB = 16;
+const int RIP_PC2 = 32;
+const int RIP_STREAM = 64;
+const int RIP_VAT = 128;
+const int RIP_DMF = 256;
+
+//names of outputs in the manifest, in the order of the RIP_ flags
+const std::string RIP_NAMES[9] = {"tex", "dae", "obj", "frames", "glb", "pc2", "stream", "vat", "dmf"};
+
+//version of the files written by the ripper, recorded in the manifest
+//must be increased by any change which alters the bytes of an output, so that --incremental regenerates outputs from older versions
+const int OUTPUT_VERSION = 1;
+
+//converts a comma separated list of format names into RIP_ flags
+//returns -1 if a format name is not recognised
+int parse_formats(std::string formats) {
+
+    int flags = 0;
+
+    //name of current format in list
+    std::string format;
+
+    //position of next comma in list
+    size_t comma;
+
+    while (formats.size() > 0) {
+
+        comma = formats.find(',');
+
+        format = formats.substr(0, comma);
+
+        if (comma == std::string::npos) {
+
+            formats.clear();
+
+        } else {
+
+            formats.erase(0, comma + 1);
+        }
+
+        //textures are always written alongside the formats that reference them
+        if (format == "dae") {
+
+            flags |= RIP_DAE | RIP_TEXTURES;
+
+        } else if (format == "obj") {
+
+            flags |= RIP_OBJ | RIP_TEXTURES;
+
+        } else if (format == "frames") {
+
+            flags |= RIP_FRAMES | RIP_TEXTURES;
+
+        //point caches are used with the obj file, so it is written too
+        } else if (format == "pc2") {
+
+            flags |= RIP_PC2 | RIP_OBJ | RIP_TEXTURES;
+
+        //frame streams are used with the obj file, so it is written too
+        } else if (format == "stream") {
+
+            flags |= RIP_STREAM | RIP_OBJ | RIP_TEXTURES;
+
+        //vertex animation textures are used with the obj file, so it is written too
+        } else if (format == "vat") {
+
+            flags |= RIP_VAT | RIP_OBJ | RIP_TEXTURES;
+
+        //glb files contain their own textures
+        } else if (format == "glb") {
+
+            flags |= RIP_GLB;
+
+        //dmf files contain their own textures
+        } else if (format == "dmf") {
+
+            flags |= RIP_DMF;
+
+        } else if (format == "tex") {
+
+            flags |= RIP_TEXTURES;
+
+        } else {
+
+            return -1;
+        }
+    }
+
+    if (flags == 0) return -1;
+
+    return flags;
+}
+
+//returns the settings recorded in the manifest for the output with flag
+//settings include the output version of the ripper, so that outputs from older versions are regenerated, and the options which affect the output
+std::string output_settings(int flag, std::string float_style, bool gzip_output, bool cache_normals, bool shared_topology, bool vat_float, int texture_format, bool mipmaps, bool atlas) {
+
+    std::string settings = "version=" + std::to_string(OUTPUT_VERSION);
+
+    //text outputs depend on the float style and compression
+    if (flag & (RIP_DAE | RIP_OBJ | RIP_FRAMES)) {
+
+        settings += ";float=" + float_style + ";gzip=" + std::to_string(gzip_output);
+    }
+
+    //textures, and the mtl and dae files which refer to them, depend on the texture format
+    if (flag & (RIP_TEXTURES | RIP_DAE | RIP_OBJ | RIP_FRAMES)) {
+
+        settings += ";textures=" + std::to_string(texture_format) + ";mipmaps=" + std::to_string(mipmaps);
+    }
+
+    //combining textures changes the textures, uvs, and face order of every output which holds them
+    if (flag & (RIP_TEXTURES | RIP_DAE | RIP_OBJ | RIP_FRAMES | RIP_GLB | RIP_DMF)) {
+
+        settings += ";atlas=" + std::to_string(atlas);
+    }
+
+    if (flag & (RIP_FRAMES | RIP_PC2)) {
+
+        settings += ";cache_normals=" + std::to_string(cache_normals);
+    }
+
+    if (flag & RIP_FRAMES) {
+
+        settings += ";shared_topology=" + std::to_string(shared_topology);
+    }
+
+    if (flag & RIP_VAT) {
+
+        settings += ";vat_float=" + std::to_string(vat_float);
+    }
+
+    //manifest fields are separated by spaces
+    for (int i = 0; i < settings.size(); i++) {
+
+        if (settings[i] == ' ') {
+
+            settings[i] = '_';
+        }
+    }
+
+    return settings;
+}
 
 int main(int argc, char *argv[]) {
 
@@ -49,8 +214,396 @@ int main(int argc, char *argv[]) {
     MON_ROT_HACK_LIST[675] = true;
     MON_ROT_HACK_LIST[680] = true;
 
+    //command line arguments, excluding options
+    std::vector<std::string> args;
+
+    //number of background threads used to write output files, 0 writes files on the main thread
+    int n_writers = 4;
+
+    //true if point caches should include vertex normals
+    bool cache_normals = false;
+
+    //true if frame obj files should only contain vertices, sharing the topology of the main obj file
+    bool shared_topology = false;
+
+    //true if vertex animation textures should hold 32 bit floats instead of 16 bit values
+    bool vat_float = false;
+
+    //true if each monster's textures should be combined into a single texture atlas
+    bool atlas = false;
+
+    //pack file that all output is written to, or empty to write files to the models directory
+    std::string pack_path;
+
+    //true if all output should be written to stdout as a tar stream
+    bool tar_output = false;
+
+    //name of the float style selected with --float=
+    std::string float_style = "default";
+
+    //true if monsters which are unchanged since the last run should be skipped
+    bool incremental = false;
+
+    //true if binary outputs should be read back and checked against the model after they are written
+    bool verify = false;
+
+    //true if any output failed verification
+    bool verify_failed = false;
+
+    //true if text files should be compressed with gzip
+    bool gzip_output = false;
+
+    //number of threads used to compress the blocks of each file
+    int n_gzip_threads = 1;
+
+    //pack file to list or extract, instead of ripping models
+    std::string list_path;
+    std::string extract_path;
+
+    //read options, which begin with "--"
+    for (int i = 1; i < argc; i++) {
+
+        std::string arg = argv[i];
+
+        //style used for floating point values in text output
+        if (arg.compare(0, 8, "--float=") == 0) {
+
+            if (!NumberFormat::select(arg.substr(8))) {
+
+                std::cout << "Error, float style must be shortest, fixedN, or generalN\n";
+
+                return 1;
+            }
+
+            float_style = arg.substr(8);
+
+        //file format of textures
+        } else if (arg.compare(0, 11, "--textures=") == 0) {
+
+            if (arg.substr(11) == "bmp") {
+
+                ModelRipper::texture_format = TexRipper::BMP;
+
+            } else if (arg.substr(11) == "png") {
+
+                ModelRipper::texture_format = TexRipper::PNG;
+
+            } else if (arg.substr(11) == "bmp8") {
+
+                ModelRipper::texture_format = TexRipper::BMP8;
+
+            } else if (arg.substr(11) == "png8") {
+
+                ModelRipper::texture_format = TexRipper::PNG8;
+
+            } else if (arg.substr(11) == "dds") {
+
+                ModelRipper::texture_format = TexRipper::DDS;
+
+            } else {
+
+                std::cout << "Error, texture format must be bmp, png, bmp8, png8, or dds\n";
+
+                return 1;
+            }
+
+        //write vertex normals to point caches
+        } else if (arg == "--cache-normals") {
+
+            cache_normals = true;
+
+        //write only vertices to frame obj files
+        } else if (arg == "--shared-topology") {
+
+            shared_topology = true;
+
+        //write vertex animation textures as floats
+        } else if (arg == "--vat-float") {
+
+            vat_float = true;
+
+        //write all output to a single pack file
+        } else if (arg.compare(0, 7, "--pack=") == 0) {
+
+            pack_path = arg.substr(7);
+
+        //write all output to stdout as a tar stream
+        } else if (arg == "--tar") {
+
+            tar_output = true;
+
+        //skip monsters recorded in the manifest as up to date
+        } else if (arg == "--incremental") {
+
+            incremental = true;
+
+        //read back and check binary outputs
+        } else if (arg == "--verify") {
+
+            verify = true;
+
+        //compress text files
+        } else if (arg == "--gzip") {
+
+            gzip_output = true;
+
+        //generate mipmaps for dds textures
+        } else if (arg == "--mipmaps") {
+
+            TexRipper::mipmaps = true;
+
+        //combine each monster's textures into one texture
+        } else if (arg == "--atlas") {
+
+            atlas = true;
+
+        //number of threads used to compress each dds texture
+        } else if (arg.compare(0, 18, "--texture-threads=") == 0) {
+
+            try {
+
+                TexRipper::n_threads = std::stoi(arg.substr(18));
+
+            } catch(const std::invalid_argument& e) {
+
+                TexRipper::n_threads = 0;
+            }
+
+            if (TexRipper::n_threads < 1) {
+
+                std::cout << "Error, number of texture threads must be a number greater than 0\n";
+
+                return 1;
+            }
+
+        //number of threads used to compress each file
+        } else if (arg.compare(0, 15, "--gzip-threads=") == 0) {
+
+            gzip_output = true;
+
+            try {
+
+                n_gzip_threads = std::stoi(arg.substr(15));
+
+            } catch(const std::invalid_argument& e) {
+
+                n_gzip_threads = 0;
+            }
+
+            if (n_gzip_threads < 1) {
+
+                std::cout << "Error, number of gzip threads must be a number greater than 0\n";
+
+                return 1;
+            }
+
+        //list files in a pack file
+        } else if (arg.compare(0, 7, "--list=") == 0) {
+
+            list_path = arg.substr(7);
+
+        //extract files from a pack file
+        } else if (arg.compare(0, 10, "--extract=") == 0) {
+
+            extract_path = arg.substr(10);
+
+        //number of threads used to write files
+        } else if (arg.compare(0, 10, "--writers=") == 0) {
+
+            try {
+
+                n_writers = std::stoi(arg.substr(10));
+
+            } catch(const std::invalid_argument& e) {
+
+                n_writers = -1;
+            }
+
+            if (n_writers < 0) {
+
+                std::cout << "Error, number of writers must be a number greater than or equal to 0\n";
+
+                return 1;
+            }
+
+        } else {
+
+            args.push_back(arg);
+        }
+    }
+
+    if (tar_output && pack_path != "") {
+
+        std::cout << "Error, --tar and --pack cannot be used together\n";
+
+        return 1;
+    }
+
+    if (incremental && (tar_output || pack_path != "")) {
+
+        std::cout << "Error, --incremental can only be used when writing to the models directory\n";
+
+        return 1;
+    }
+
+    if (verify && (tar_output || pack_path != "")) {
+
+        std::cout << "Error, --verify can only be used when writing to the models directory\n";
+
+        return 1;
+    }
+
+    if (TexRipper::mipmaps && ModelRipper::texture_format != TexRipper::DDS) {
+
+        std::cout << "Error, --mipmaps can only be used with --textures=dds\n";
+
+        return 1;
+    }
+
+    //an atlas combines textures with different palettes, so it cannot be written with a single palette
+    if (atlas && (ModelRipper::texture_format == TexRipper::BMP8 || ModelRipper::texture_format == TexRipper::PNG8)) {
+
+        std::cout << "Error, --atlas cannot be used with --textures=bmp8 or --textures=png8\n";
+
+        return 1;
+    }
+
+    //stdout carries the tar stream, so messages are sent to stderr instead
+    if (tar_output) {
+
+        std::cout.rdbuf(std::cerr.rdbuf());
+
+        #ifdef _WIN32
+
+        _setmode(_fileno(stdout), _O_BINARY);
+
+        #endif
+    }
+
+    //list size and path of each file in a pack
+    //usage: ripper --list=pack
+    if (list_path != "") {
+
+        PackReader pack_reader;
+
+        if (!pack_reader.open(list_path)) {
+
+            std::cout << "Error, could not read pack file " << list_path << "\n";
+
+            return 1;
+        }
+
+        const std::vector<PackEntry> &entries = pack_reader.list();
+
+        for (int i = 0; i < entries.size(); i++) {
+
+            std::cout << entries[i].size << " " << entries[i].path << "\n";
+        }
+
+        return 0;
+    }
+
+    //extract files from a pack into the working directory, keeping their paths
+    //if any paths are given, only files whose paths begin with one of them are extracted
+    //usage: ripper --extract=pack [paths]
+    if (extract_path != "") {
+
+        PackReader pack_reader;
+
+        if (!pack_reader.open(extract_path)) {
+
+            std::cout << "Error, could not read pack file " << extract_path << "\n";
+
+            return 1;
+        }
+
+        const std::vector<PackEntry> &entries = pack_reader.list();
+
+        DirectoryTarget directory_target;
+
+        //data of current file
+        std::vector<char> file_data;
+
+        //true if any selected file could not be extracted
+        bool extract_failed = false;
+
+        for (int i = 0; i < entries.size(); i++) {
+
+            bool selected = args.size() == 0;
+
+            for (int j = 0; j < args.size() && !selected; j++) {
+
+                selected = entries[i].path.compare(0, args[j].size(), args[j]) == 0;
+            }
+
+            if (!selected) continue;
+
+            //paths must stay inside the working directory
+            std::filesystem::path entry_path(entries[i].path);
+
+            bool outside = entry_path.has_root_path();
+
+            for (std::filesystem::path::iterator it = entry_path.begin(); it != entry_path.end() && !outside; it++) {
+
+                outside = *it == "..";
+            }
+
+            if (outside) {
+
+                std::cout << "Error, " << entries[i].path << " in pack file is outside the current directory\n";
+
+                return 1;
+            }
+
+            if (!pack_reader.read(entries[i], file_data)) {
+
+                std::cout << "Error, could not read " << entries[i].path << " from pack file\n";
+
+                return 1;
+            }
+
+            //create directories in path
+            std::filesystem::path parent = entry_path.parent_path();
+
+            if (!parent.empty()) {
+
+                //fails if a file is in the way of a directory, which only affects this entry
+                std::error_code error;
+
+                std::filesystem::create_directories(parent, error);
+
+                if (error) {
+
+                    std::cout << "Error, could not create directory " << parent.string() << " for " << entries[i].path << "\n";
+
+                    extract_failed = true;
+
+                    continue;
+                }
+            }
+
+            OutFile extracted_file(directory_target, entries[i].path);
+
+            extracted_file.write(file_data.data(), file_data.size());
+
+            if (!extracted_file.close()) {
+
+                extract_failed = true;
+            }
+        }
+
+        return extract_failed ? 1 : 0;
+    }
+
+    if (args.size() == 0) {
+
+        std::cout << "Error, no MONSTER.MRG file given\n";
+
+        return 1;
+    }
+
     //open MONSTER.MRG
-    std::ifstream Monster_MRG(argv[1], std::ios::binary);
+    std::ifstream Monster_MRG(args[0], std::ios::binary);
 
     //Find length of MONSTER.MRG
     std::streampos MRG_length = Monster_MRG.tellg();
@@ -62,6 +615,9 @@ int main(int argc, char *argv[]) {
     Monster_MRG.seekg(0, std::ios::beg);
     Monster_MRG.read(buffer, MRG_length);
 
+    //size of MONSTER.MRG in bytes
+    long long MRG_size = static_cast<long long>(MRG_length);
+
     //stores user input
     std::string user_input;
 
@@ -69,16 +625,56 @@ int main(int argc, char *argv[]) {
     int start_monster = -1;
     int end_monster = -1;
     
-    //specifies how models should be ripped
-    //0: extract mesh + skeleton + animations to dae file
-    //1: extract mesh to obj file
-    //2: extract meshes for each frame of animation to obj files
-    int rip_mode = -1;
+    //specifies which outputs should be generated, as a combination of RIP_ flags
+    //all selected outputs are produced from a single extraction of each monster
+    int rip_formats = -1;
+
+    //menu option chosen by the user
+    std::string menu_option;
 
     //loop completion tracker
     bool loop_done = false;
     bool loop_2_done = false;
 
+    //formats and range may be given on the command line instead of using the menu
+    //usage: ripper MONSTER.MRG formats [start_id end_id] [--float=style] [--writers=N] [--pack=file] [--tar] [--incremental] [--gzip] [--gzip-threads=N] [--cache-normals] [--shared-topology] [--vat-float]
+    if (args.size() > 1) {
+
+        rip_formats = parse_formats(args[1]);
+
+        if (rip_formats == -1) {
+
+            std::cout << "Error, formats must be a comma separated list of dae, obj, frames, pc2, stream, vat, glb, dmf, and tex\n";
+
+            return 1;
+        }
+
+        start_monster = 0;
+        end_monster = 683;
+
+        if (args.size() > 3) {
+
+            try {
+
+                start_monster = std::stoi(args[2]);
+                end_monster = std::stoi(args[3]) + 1;
+
+            } catch(const std::invalid_argument& e) {
+
+                start_monster = -1;
+            }
+
+            if (start_monster < 0 || start_monster >= end_monster || end_monster > 683) {
+
+                std::cout << "Error, monster IDs must be numbers between 0 and 682 inclusive, with start ID less than end ID\n";
+
+                return 1;
+            }
+        }
+
+        loop_done = true;
+    }
+
     while (!loop_done) {
 
         std::cout << "DOTR Model Ripper\n"
@@ -87,35 +683,56 @@ int main(int argc, char *argv[]) {
             "2) Generate dae files for monsters in a specific range\n"
             "3) Generate obj files for all monsters (no skeleton or animation)\n"
             "4) Generate obj files for monsters in a specific range\n"
-            "5) Generate a monster's animation frames as separate obj files\n";
+            "5) Generate a monster's animation frames as separate obj files\n"
+            "6) Generate any combination of formats for monsters in a specific range\n";
 
         std::cin >> user_input;
 
-        //set rip_mode using user input
-        if (user_input == "1" || user_input == "2") {
+        menu_option = user_input;
 
-            rip_mode = 0;
+        //set rip_formats using user input
+        if (menu_option == "1" || menu_option == "2") {
+
+            rip_formats = RIP_DAE | RIP_TEXTURES;
         }
 
-        if (user_input == "3" || user_input == "4") {
+        if (menu_option == "3" || menu_option == "4") {
 
-            rip_mode = 1;
+            rip_formats = RIP_OBJ | RIP_TEXTURES;
         }
 
-        if (user_input == "5") {
+        if (menu_option == "5") {
 
-            rip_mode = 2;
+            rip_formats = RIP_FRAMES | RIP_TEXTURES;
+        }
+
+        //user is prompted to list the formats to generate
+        if (menu_option == "6") {
+
+            while (rip_formats == -1) {
+
+                std::cout << "Please input a comma separated list of formats to generate (dae, obj, frames, pc2, stream, vat, glb, dmf, tex)\n";
+
+                std::cin >> user_input;
+
+                rip_formats = parse_formats(user_input);
+
+                if (rip_formats == -1) {
+
+                    std::cout << "Error, formats must be a comma separated list of dae, obj, frames, pc2, stream, vat, glb, dmf, and tex\n";
+                }
+            }
         }
 
         //range endpoints set such that models for all monsters are extracted
-        if (user_input == "1" || user_input == "3") {
+        if (menu_option == "1" || menu_option == "3") {
 
             start_monster = 0;
             end_monster = 683;
         }
 
         //user is prompted to input two numbers corresponding to a range of monster IDs
-        if (user_input == "2" || user_input == "4") {
+        if (menu_option == "2" || menu_option == "4" || menu_option == "6") {
 
             while (!loop_2_done) {
 
@@ -168,7 +785,7 @@ int main(int argc, char *argv[]) {
         }
 
         //user is prompted to input a single number corresponding to a single monster's ID
-        if (user_input == "5") {
+        if (menu_option == "5") {
 
             while(!loop_2_done) {
 
@@ -203,46 +820,261 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if (rip_mode != -1 && start_monster != -1 && end_monster != -1) {
+        if (rip_formats != -1 && start_monster != -1 && end_monster != -1) {
 
             loop_done = true;
         }
     }
 
+    //files are written to the file system, to a single pack file if one was given, or to stdout as a tar stream
+    DirectoryTarget directory_target;
+    PackTarget *pack_target = nullptr;
+    TarTarget *tar_target = nullptr;
+    OutputTarget *base_target = &directory_target;
+
+    if (tar_output) {
+
+        tar_target = new TarTarget(stdout);
+
+        base_target = tar_target;
+    }
+
+    if (pack_path != "") {
+
+        pack_target = new PackTarget(pack_path);
+
+        if (!pack_target->is_open()) {
+
+            delete pack_target;
+
+            return 1;
+        }
+
+        base_target = pack_target;
+    }
+
+    //text files are compressed before being written
+    GzipTarget *gzip_target = nullptr;
+
+    if (gzip_output) {
+
+        gzip_target = new GzipTarget(*base_target, n_gzip_threads);
+
+        base_target = gzip_target;
+    }
+
+    //files are passed on by background writer threads, so ripping never waits on the disk or for compression
+    AsyncTarget *async_target = nullptr;
+
+    if (n_writers > 0) {
+
+        async_target = new AsyncTarget(*base_target, n_writers);
+
+        OutputTarget::set_default(async_target);
+
+    } else {
+
+        OutputTarget::set_default(base_target);
+    }
+
+    //target that all output files are written to
+    OutputTarget &target = OutputTarget::get_default();
+
     //make directories
-    std::filesystem::create_directory("models");
+    target.create_directory("models");
+
+    //outputs produced by previous runs, read only if monsters which have not changed should be skipped
+    Manifest manifest;
+
+    //manifest settings for each output
+    std::string settings[9];
+
+    if (incremental) {
+
+        manifest.load("models/manifest.txt");
+
+        for (int i = 0; i < 9; i++) {
+
+            settings[i] = output_settings(1 << i, float_style, gzip_output, cache_normals, shared_topology, vat_float, ModelRipper::texture_format, TexRipper::mipmaps, atlas);
+        }
+    }
 
     //variables used to store strings for reuse
     std::string mon_filepath;
     std::string mon_ID;
 
-    for (int i = start_monster; i < end_monster; i++) {
+    //hash of the current monster's data in MONSTER.MRG
+    std::string mon_hash;
 
-        std::cout << "EXTRACTING MONSTER " << i << ", " << MON_NAMES_LIST[i] << "\n";
+    //outputs generated for the current monster, as a combination of RIP_ flags
+    int mon_formats;
+
+    for (int i = start_monster; i < end_monster; i++) {
 
         mon_ID = std::to_string(i);
         mon_filepath = "models/" + mon_ID + " - " + MON_NAMES_LIST[i];
 
-        std::filesystem::create_directory(mon_filepath);
+        mon_formats = rip_formats;
+
+        //only generate outputs whose monster data or settings have changed, unless the monster's directory has been removed
+        if (incremental) {
+
+            mon_hash = Hash::hex(Hash::hash64(buffer + i*0x100000, std::max(0LL, std::min(0x100000LL, MRG_size - i*0x100000LL))));
+
+            if (std::filesystem::exists(mon_filepath)) {
+
+                for (int j = 0; j < 9; j++) {
+
+                    if ((mon_formats & (1 << j)) && manifest.up_to_date(i, RIP_NAMES[j], mon_hash, settings[j])) {
+
+                        mon_formats &= ~(1 << j);
+                    }
+                }
+            }
+
+            if (mon_formats == 0) {
+
+                std::cout << "SKIPPING MONSTER " << i << ", " << MON_NAMES_LIST[i] << "\n";
+
+                continue;
+            }
+        }
+
+        std::cout << "EXTRACTING MONSTER " << i << ", " << MON_NAMES_LIST[i] << "\n";
+
+        target.create_directory(mon_filepath);
 
         ModelRipper::rip(buffer, i*0x100000);
 
-        if (rip_mode == 0) {
+        //textures are kept separate if they cannot be combined
+        if (atlas && !ModelRipper::build_atlas()) {
+
+            std::cout << "Writing separate textures for monster " << i << "\n";
+        }
+
+        //run each selected exporter on the extracted model
+        if (mon_formats & RIP_TEXTURES) {
+
+            ModelRipper::write_textures(mon_filepath + "/", mon_ID);
+        }
+
+        if (mon_formats & RIP_DAE) {
 
             ModelRipper::to_collada(mon_filepath + "/", mon_ID);
-            ModelRipper::reset();
+        }
 
-        } else if (rip_mode == 1) {
+        if (mon_formats & (RIP_OBJ | RIP_FRAMES)) {
 
             ModelRipper::generate_mtl(mon_filepath + "/", mon_ID);
+        }
+
+        //frames with shared topology use the uvs and faces of the main obj file
+        if ((mon_formats & RIP_OBJ) || ((mon_formats & RIP_FRAMES) && shared_topology)) {
+
             ModelRipper::to_obj(mon_filepath + "/", mon_ID);
-            ModelRipper::reset();
-        
-        } else if (rip_mode == 2) {
+        }
 
-            ModelRipper::generate_mtl(mon_filepath + "/", mon_ID);
-            ModelRipper::animations_as_obj(buffer, i*0x100000, mon_filepath + "/", mon_ID);
+        if (mon_formats & RIP_PC2) {
+
+            ModelRipper::animations_as_pc2(mon_filepath + "/", mon_ID, cache_normals);
+        }
+
+        if (mon_formats & RIP_STREAM) {
+
+            ModelRipper::animations_as_stream(mon_filepath + "/", mon_ID);
         }
+
+        if (mon_formats & RIP_VAT) {
+
+            ModelRipper::animations_as_vat(mon_filepath + "/", mon_ID, vat_float);
+        }
+
+        if (mon_formats & RIP_GLB) {
+
+            ModelRipper::to_glb(mon_filepath + "/", mon_ID);
+        }
+
+        if (mon_formats & RIP_DMF) {
+
+            ModelRipper::to_dmf(mon_filepath + "/", mon_ID);
+        }
+
+        if (mon_formats & RIP_FRAMES) {
+
+            ModelRipper::animations_as_obj(mon_filepath + "/", mon_ID, shared_topology, cache_normals);
+        }
+
+        //read binary outputs back once they have been written
+        if (verify && (mon_formats & (RIP_STREAM | RIP_DMF))) {
+
+            if (async_target != nullptr) {
+
+                async_target->finish();
+            }
+
+            if ((mon_formats & RIP_STREAM) && !ModelRipper::verify_stream(mon_filepath + "/", mon_ID)) {
+
+                verify_failed = true;
+            }
+
+            if ((mon_formats & RIP_DMF) && !ModelRipper::verify_dmf(mon_filepath + "/", mon_ID)) {
+
+                verify_failed = true;
+            }
+        }
+
+        ModelRipper::reset();
+
+        if (incremental) {
+
+            for (int j = 0; j < 9; j++) {
+
+                if (mon_formats & (1 << j)) {
+
+                    manifest.record(i, RIP_NAMES[j], mon_hash, settings[j]);
+                }
+            }
+        }
+    }
+
+    //wait for queued files to be written
+    delete async_target;
+
+    delete gzip_target;
+
+    //write directory of pack file
+    delete pack_target;
+
+    //write end of tar stream
+    delete tar_target;
+
+    //record outputs once all files have been written
+    if (incremental) {
+
+        //outputs of monsters with files which could not be written are produced again by the next run
+        for (int i = start_monster; i < end_monster; i++) {
+
+            if (OutputTarget::has_failed("models/" + std::to_string(i) + " - " + MON_NAMES_LIST[i] + "/")) {
+
+                manifest.forget(i);
+            }
+        }
+
+        manifest.save(directory_target, "models/manifest.txt");
+    }
+
+    if (OutputTarget::has_failed()) {
+
+        std::cout << "Error, some files could not be written\n";
+
+        return 1;
+    }
+
+    if (verify_failed) {
+
+        std::cout << "Error, some outputs did not match the model\n";
+
+        return 1;
     }
 
     return 0;